@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace at {
+	/// <summary>
+	/// 后台截图服务，它在独立线程上以指定帧率截取屏幕，并通过三缓冲提供最新的帧，使截图与图片匹配可以并行进行
+	/// </summary>
+	class auto_capture
+	{
+	public:
+		/// <summary>
+		/// 一帧屏幕数据
+		/// </summary>
+		struct frame
+		{
+			/// BGRA四通道的屏幕矩阵，可以直接传给auto_screen::find_img_from_mat
+			cv::Mat image;
+			/// 帧序号，从1开始递增，为0表示还没有任何帧
+			uint64_t sequence = 0;
+			/// 截图完成的时间
+			std::chrono::steady_clock::time_point timestamp;
+		};
+
+	public:
+		auto_capture() {}
+		~auto_capture() { stop(); }
+
+		auto_capture(const auto_capture&) = delete;
+		auto_capture& operator=(const auto_capture&) = delete;
+
+	public:
+		/// <summary>
+		/// 启动截图线程
+		/// </summary>
+		/// <param name="frame_rate">每秒截图的次数</param>
+		/// <returns>操作是否成功，若已经启动或帧率不大于0，则返回false</returns>
+		bool start(int frame_rate = 30);
+
+		/// <summary>
+		/// 停止截图线程，并唤醒所有正在等待新帧的消费者
+		/// </summary>
+		void stop();
+
+		/// <summary>
+		/// 截图线程是否正在运行
+		/// </summary>
+		/// <returns>截图线程是否正在运行</returns>
+		bool is_running() const { return running; }
+
+		/// <summary>
+		/// 立即获取最新的帧，不会阻塞。返回的引用在同一消费者下次调用latest_frame或wait_newer_frame之前有效，
+		/// 截图线程不会写入这一帧，所以只能有一个消费者线程调用这两个函数
+		/// </summary>
+		/// <returns>最新的帧，若还没有任何帧，则其sequence为0</returns>
+		const frame& latest_frame();
+
+		/// <summary>
+		/// 阻塞直到出现比指定序号更新的帧，然后返回最新的帧，返回的引用的有效期与latest_frame相同
+		/// </summary>
+		/// <param name="sequence">已经处理过的帧序号</param>
+		/// <param name="timeout_millisecond">最多等待的毫秒数，小于0表示一直等待</param>
+		/// <returns>最新的帧，若超时或服务停止，其sequence可能不大于指定序号</returns>
+		const frame& wait_newer_frame(uint64_t sequence, int timeout_millisecond = -1);
+
+	private:
+		void _capture_loop(std::chrono::steady_clock::duration interval);
+
+	private:
+		// middle_index的低两位是中间缓冲的下标，fresh_bit表示中间缓冲是否有消费者还没取走的新帧
+		static constexpr uint8_t index_mask = 0x3;
+		static constexpr uint8_t fresh_bit = 0x4;
+
+		frame frames[3];
+		std::atomic<uint8_t> middle_index{ 1 };
+		// 只由截图线程访问
+		uint8_t back_index = 0;
+		// 只由消费者线程访问
+		uint8_t front_index = 2;
+
+		std::atomic<uint64_t> published_sequence{ 0 };
+		std::atomic<bool> running{ false };
+		std::mutex wait_mutex;
+		std::condition_variable wait_cv;
+		std::thread capture_thread;
+	};
+};//at
+
@@ -0,0 +1,130 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "auto_input.h"
+
+namespace at {
+	/// <summary>
+	/// 线程安全的输入分发器，它在独立线程上独占一个auto_input，多个线程通过无锁队列向它提交输入动作
+	/// </summary>
+	class auto_dispatcher
+	{
+	public:
+		/// 输入动作，它在分发线程上执行，返回操作是否成功
+		using action_type = std::function<bool(auto_input&)>;
+
+		enum class priority_type :int {
+			/// 高优先级，排在所有普通和低优先级动作之前执行
+			high,
+			/// 普通优先级
+			normal,
+			/// 低优先级
+			low
+		};
+
+	private:
+		enum class action_status :int {
+			queued,
+			running,
+			cancelled
+		};
+
+		struct action_state
+		{
+			action_type action;
+			priority_type priority = priority_type::normal;
+			std::atomic<action_status> status{ action_status::queued };
+			std::promise<bool> promise;
+		};
+
+		struct queue_node
+		{
+			std::atomic<queue_node*> next{ nullptr };
+			std::shared_ptr<action_state> state;
+		};
+
+	public:
+		/// <summary>
+		/// 已提交动作的句柄，用于等待其完成或取消它
+		/// </summary>
+		class action_handle
+		{
+		public:
+			/// <summary>
+			/// 取消还在队列中的动作，已经开始执行的动作无法取消。取消成功后result的值为false
+			/// </summary>
+			/// <returns>是否取消成功</returns>
+			bool cancel()
+			{
+				auto expected = action_status::queued;
+				if (!state || !state->status.compare_exchange_strong(expected, action_status::cancelled))
+					return false;
+				state->promise.set_value(false);
+				return true;
+			}
+
+			/// 动作完成时得到其返回值，被取消或分发器停止时为false
+			std::future<bool> result;
+
+		private:
+			friend class auto_dispatcher;
+			std::shared_ptr<action_state> state;
+		};
+
+	public:
+		auto_dispatcher();
+		~auto_dispatcher();
+
+		auto_dispatcher(const auto_dispatcher&) = delete;
+		auto_dispatcher& operator=(const auto_dispatcher&) = delete;
+
+	public:
+		/// <summary>
+		/// 启动分发线程，启动之前提交的动作会在启动后执行
+		/// </summary>
+		/// <returns>操作是否成功，若已经启动，则返回false</returns>
+		bool start();
+
+		/// <summary>
+		/// 停止分发线程，正在执行的动作会执行完毕，队列中剩余的动作全部被取消
+		/// </summary>
+		void stop();
+
+		/// <summary>
+		/// 提交一个输入动作，可以在任意线程调用。同一个线程以相同优先级提交的动作按提交顺序执行
+		/// </summary>
+		/// <param name="action">输入动作，例如 [](at::auto_input&amp; ai) { return ai.click(100, 100); }</param>
+		/// <param name="priority">动作的优先级</param>
+		/// <returns>动作的句柄</returns>
+		action_handle post(action_type action, priority_type priority = priority_type::normal);
+
+	private:
+		void _push(queue_node* node);
+		std::shared_ptr<action_state> _pop();
+		bool _queue_empty() const;
+		void _dispatch_loop();
+		void _run_action(const std::shared_ptr<action_state>& state, auto_input& input);
+
+	private:
+		// Vyukov式的多生产者单消费者队列：生产者只交换queue_head，消费者独占queue_tail
+		std::atomic<queue_node*> queue_head;
+		queue_node* queue_tail;
+
+		// 只由分发线程访问，按优先级暂存已经从队列中取出的动作
+		std::deque<std::shared_ptr<action_state>> pending[3];
+
+		std::atomic<bool> running{ false };
+		std::atomic<bool> sleeping{ false };
+		std::mutex wake_mutex;
+		std::condition_variable wake_cv;
+		std::thread dispatch_thread;
+	};
+};//at
+
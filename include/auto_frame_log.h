@@ -0,0 +1,115 @@
+#pragma once
+#include <fstream>
+#include "auto_capture.h"
+
+namespace at {
+	/// <summary>
+	/// 帧日志记录器，它在后台线程上把连续的截图编码为关键帧和相对于关键帧变化的图块，用LZ4压缩后写入文件，
+	/// 用于事后查看机器人实际看到的画面，写出的文件可以由auto_frame_replay回放
+	/// </summary>
+	class auto_frame_logger
+	{
+	public:
+		auto_frame_logger() {}
+		~auto_frame_logger() { close(); }
+
+		auto_frame_logger(const auto_frame_logger&) = delete;
+		auto_frame_logger& operator=(const auto_frame_logger&) = delete;
+
+	public:
+		/// <summary>
+		/// 创建日志文件并启动编码线程
+		/// </summary>
+		/// <param name="file_name">日志文件的文件名，已存在的文件会被覆盖</param>
+		/// <param name="tile_size">图块的边长，单位为像素</param>
+		/// <param name="keyframe_interval">每隔多少帧强制写一次关键帧</param>
+		/// <param name="queue_capacity">等待编码的帧最多有多少个，队列满时新的帧会被丢弃</param>
+		/// <returns>操作是否成功</returns>
+		bool open(const std::string& file_name, int tile_size = 64, int keyframe_interval = 300, size_t queue_capacity = 4);
+
+		/// <summary>
+		/// 编码完队列中剩余的帧，然后关闭日志文件
+		/// </summary>
+		void close();
+
+		/// <summary>
+		/// 把一帧交给编码线程，帧数据会被复制，因此调用后可以立即复用传入的帧
+		/// </summary>
+		/// <param name="f">要记录的帧，图片必须是BGRA四通道</param>
+		/// <returns>是否已加入队列，若日志未打开或队列已满，则返回false</returns>
+		bool push(const auto_capture::frame& f);
+
+		/// <summary>
+		/// 获取因队列已满或压缩失败而丢弃的帧数
+		/// </summary>
+		/// <returns>丢弃的帧数</returns>
+		size_t dropped_frames() const { return dropped_count; }
+
+	private:
+		void _encode_loop();
+		void _encode(const auto_capture::frame& f);
+
+	private:
+		std::ofstream file;
+		int tile_edge = 64;
+		int keyframe_period = 300;
+
+		// 环形队列，slots在open时分配，之后复用其中的矩阵
+		std::vector<auto_capture::frame> slots;
+		size_t queue_head = 0;
+		size_t queue_count = 0;
+		// push和编码线程都会增加它，dropped_frames随时可以读取
+		std::atomic<size_t> dropped_count{ 0 };
+		bool closing = false;
+		std::mutex queue_mutex;
+		std::condition_variable queue_cv;
+		std::thread encode_thread;
+
+		// 只由编码线程访问的工作区
+		cv::Mat keyframe;
+		int frames_since_keyframe = 0;
+		std::vector<uint32_t> changed_tiles;
+		std::vector<char> raw_buffer;
+		std::vector<char> compressed_buffer;
+	};
+
+	/// <summary>
+	/// 帧日志回放器，它按记录的顺序还原auto_frame_logger写出的每一帧，
+	/// 还原出的帧可以再次交给auto_screen::find_img_from_mat等匹配函数，从而离线地复现和测试匹配过程
+	/// </summary>
+	class auto_frame_replay
+	{
+	public:
+		/// <summary>
+		/// 打开日志文件
+		/// </summary>
+		/// <param name="file_name">日志文件的文件名</param>
+		/// <returns>操作是否成功，若文件不存在或格式不对，则返回false</returns>
+		bool open(const std::string& file_name);
+
+		/// <summary>
+		/// 读取下一帧
+		/// </summary>
+		/// <param name="f">[out]还原出的帧，若其中的矩阵大小相符，则复用其内存</param>
+		/// <returns>是否读取成功，到达文件末尾或文件损坏时返回false</returns>
+		bool next_frame(auto_capture::frame& f);
+
+		/// <summary>
+		/// 回到第一帧
+		/// </summary>
+		/// <returns>操作是否成功</returns>
+		bool rewind();
+
+	private:
+		std::ifstream file;
+		std::streampos first_record;
+		std::streampos end_position;
+		int tile_edge = 64;
+
+		cv::Mat keyframe;
+		std::vector<uint32_t> changed_tiles;
+		std::vector<char> raw_buffer;
+		std::vector<char> compressed_buffer;
+	};
+};//at
+
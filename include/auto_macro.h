@@ -0,0 +1,101 @@
+#pragma once
+#include "auto_input.h"
+#include "auto_screen.h"
+
+namespace at {
+	/// <summary>
+	/// 宏脚本，它把简单的脚本语言编译为紧凑的字节码，然后在auto_input和auto_screen上解释执行。
+	/// 按键名、鼠标按键名和图片文件都在编译时解析好，执行时不再查表或读取文件。
+	///
+	/// 每行一条指令，#开头的行为注释：
+	///   move x y [millisecond_total]     将鼠标移动到指定位置
+	///   click [button] [x y]             点击鼠标，button为left、right、middle、double_left等
+	///   press name [name ...]            依次按下并弹起指定按键，name为auto_input::enum_mapping中的键盘按键，方向键写作arrow_up等
+	///   type text                        输入一行文字，大写字母和上档符号会自动按住shift
+	///   wait millisecond                 等待指定毫秒数
+	///   find file [confidence]           在屏幕中查找图片，结果供if_found和click_found使用
+	///   click_found [button]             点击最近一次find找到的位置
+	///   if_found ... [else ...] end      根据最近一次find的结果选择分支
+	///   loop count ... end               重复执行count次
+	/// </summary>
+	class auto_macro
+	{
+	public:
+		using two_tuple = std::pair<int, int>;
+
+	public:
+		/// <summary>
+		/// 编译宏脚本，编译成功后替换之前的字节码
+		/// </summary>
+		/// <param name="source">宏脚本源码</param>
+		/// <param name="error_message">[out]若不为空，编译失败时写入错误信息及其行号</param>
+		/// <returns>编译是否成功</returns>
+		bool compile(const std::string& source, std::string* error_message = nullptr);
+
+		/// <summary>
+		/// 执行已编译的字节码，任何一条指令失败时立刻停止
+		/// </summary>
+		/// <param name="input">执行输入指令的对象</param>
+		/// <param name="screen">执行find指令的对象</param>
+		/// <returns>操作是否成功</returns>
+		bool run(auto_input& input, auto_screen& screen);
+
+		/// <summary>
+		/// 获取上一次run执行的指令条数，可以用来衡量每条指令的解释开销
+		/// </summary>
+		/// <returns>上一次run执行的指令条数</returns>
+		size_t executed_steps() const { return step_count; }
+
+		/// <summary>
+		/// 获取字节码的长度，单位为int32_t
+		/// </summary>
+		/// <returns>字节码的长度</returns>
+		size_t code_size() const { return bytecode.size(); }
+
+	private:
+		enum class opcode :int32_t {
+			/// x y millisecond_total
+			move_to,
+			/// button
+			click,
+			/// button
+			click_found,
+			/// virtual_key
+			press,
+			/// text_index
+			type,
+			/// millisecond
+			wait,
+			/// template_index confidence(千分比)
+			find,
+			/// target
+			jump,
+			/// target
+			jump_if_not_found,
+			/// count exit_target
+			loop_begin,
+			/// body_target
+			loop_end,
+			halt
+		};
+
+		struct typed_key
+		{
+			WORD virtual_key;
+			bool shift;
+		};
+
+	private:
+		std::vector<int32_t> bytecode;
+		std::vector<cv::Mat> templates;
+		std::vector<std::vector<typed_key>> texts;
+		size_t max_loop_depth = 0;
+
+		// 执行期间复用的工作区
+		std::vector<int32_t> loop_counters;
+		std::vector<two_tuple> found_postion;
+		cv::Mat screen_image;
+		size_t step_count = 0;
+	};
+};//at
+
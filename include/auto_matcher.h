@@ -0,0 +1,92 @@
+#pragma once
+#include "auto_screen.h"
+
+namespace at {
+	/// <summary>
+	/// 可复用的图片匹配会话，它预先加载一组模板，并持有截图用的设备上下文、位图以及匹配所需的全部矩阵，
+	/// 这些缓冲按当前屏幕和模板集合的大小分配一次，之后的每次查找都复用它们。
+	/// 会话本身不再分配内存，但matchTemplate内部仍会申请自己的临时缓冲
+	/// </summary>
+	class auto_matcher
+	{
+	public:
+		using two_tuple = std::pair<int, int>;
+
+	public:
+		auto_matcher() = default;
+
+		auto_matcher(const auto_matcher&) = delete;
+		auto_matcher& operator=(const auto_matcher&) = delete;
+
+	public:
+		/// <summary>
+		/// 从文件加载模板图片
+		/// </summary>
+		/// <param name="img_file_name">图片的路径</param>
+		/// <returns>模板的编号，之后用它查找；若图片读取失败，则返回-1</returns>
+		int add_template(const std::string& img_file_name)
+		{
+			return add_template(cv::imread(img_file_name));
+		}
+
+		/// <summary>
+		/// 添加模板图片
+		/// </summary>
+		/// <param name="template_image">要定位的图片，BGR三通道</param>
+		/// <returns>模板的编号，之后用它查找；若图片为空或不是BGR三通道，则返回-1</returns>
+		int add_template(const cv::Mat& template_image);
+
+		/// <summary>
+		/// 按指定的屏幕大小和当前的模板集合预先分配所有缓冲，之后在同样大小的屏幕上查找时会话不会再分配内存。
+		/// 不调用它时，缓冲在第一次查找时分配
+		/// </summary>
+		/// <param name="screen_width">屏幕的宽度</param>
+		/// <param name="screen_height">屏幕的高度</param>
+		void reserve(int screen_width, int screen_height);
+
+		/// <summary>
+		/// 截取整个屏幕并定位指定模板的位置
+		/// </summary>
+		/// <param name="template_id">add_template返回的模板编号</param>
+		/// <param name="confidence">至少需要的信心，它是一个0到1的值</param>
+		/// <param name="return_all">是否返回所有达到信心的位置，为false时只返回最好的位置</param>
+		/// <returns>当信心小于指定值时，返回false，否则返回true，位置通过img_postion获取</returns>
+		bool find_img_from_screen(int template_id, double confidence = 0.9f, bool return_all = true);
+
+		/// <summary>
+		/// 从屏幕矩阵中定位指定模板的位置，它与auto_screen::find_img_from_mat的结果相同
+		/// </summary>
+		/// <param name="template_id">add_template返回的模板编号</param>
+		/// <param name="screen_image">屏幕矩阵，BGRA四通道</param>
+		/// <param name="confidence">至少需要的信心，它是一个0到1的值</param>
+		/// <param name="return_all">是否返回所有达到信心的位置，为false时只返回最好的位置</param>
+		/// <returns>当信心小于指定值时，返回false，否则返回true，位置通过img_postion获取</returns>
+		bool find_img_from_mat(int template_id, const cv::Mat& screen_image, double confidence = 0.9f, bool return_all = true);
+
+		/// <summary>
+		/// 获取最近一次查找的结果，它在下一次查找时被覆盖
+		/// </summary>
+		/// <returns>模板在屏幕中的位置</returns>
+		const std::vector<two_tuple>& img_postion() const { return postion; }
+
+		/// <summary>
+		/// 获取已添加的模板数量
+		/// </summary>
+		/// <returns>模板数量</returns>
+		size_t template_count() const { return templates.size(); }
+
+	private:
+		void _reserve_result(int screen_width, int screen_height);
+
+	private:
+		std::vector<cv::Mat> templates;
+
+		auto_screen_grabber grabber;
+		cv::Mat screen_frame;
+		cv::Mat screen_image_3channel;
+		// 按所有模板中最大的结果大小分配，每次匹配时用正确行列数的矩阵头指向它
+		cv::Mat result_buffer;
+		std::vector<two_tuple> postion;
+	};
+};//at
+
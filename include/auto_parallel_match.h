@@ -0,0 +1,61 @@
+#pragma once
+#include "auto_screen.h"
+#include "auto_thread_pool.h"
+
+namespace at {
+	/// <summary>
+	/// 并行图片匹配，它把大屏幕按行切成条带，相邻条带重叠模板高度减1行，保证不会漏掉跨越条带的位置，
+	/// 各条带在工作窃取线程池上同时执行matchTemplate，结果直接写入同一个结果矩阵的对应行，
+	/// 最后用与auto_screen::find_img_from_mat相同的方式取出位置
+	/// </summary>
+	class auto_parallel_match
+	{
+	public:
+		using two_tuple = std::pair<int, int>;
+
+	public:
+		/// <summary>
+		/// 创建并行匹配对象
+		/// </summary>
+		/// <param name="thread_count">参与匹配的线程总数，为0时取硬件线程数</param>
+		explicit auto_parallel_match(size_t thread_count = 0) : pool(thread_count) {}
+
+	public:
+		/// <summary>
+		/// 并行计算TM_SQDIFF_NORMED匹配结果
+		/// </summary>
+		/// <param name="screen_image">屏幕矩阵，BGRA四通道</param>
+		/// <param name="template_image">要定位的图片，BGR三通道</param>
+		/// <param name="match_result">[out]CV_32FC1的匹配结果，大小与对整个屏幕执行matchTemplate相同</param>
+		/// <returns>操作是否成功，若图片比屏幕大，或屏幕不是BGRA四通道、图片不是BGR三通道，则返回false</returns>
+		bool match_template(const cv::Mat& screen_image, const cv::Mat& template_image, cv::Mat& match_result);
+
+		/// <summary>
+		/// 并行地从屏幕矩阵中定位指定图片的位置，它与auto_screen::find_img_from_mat的用法和结果相同
+		/// </summary>
+		/// <param name="img_postion">[out]返回指定图片在屏幕矩阵中的位置，当函数返回true时，这个值才有意义</param>
+		/// <param name="template_image">要定位的图片，BGR三通道</param>
+		/// <param name="screen_image">屏幕矩阵，BGRA四通道</param>
+		/// <param name="confidence">至少需要的信心，它是一个0到1的值</param>
+		/// <returns>当信心小于指定值时，返回false，否则返回true</returns>
+		bool find_img_from_mat(std::vector<two_tuple>& img_postion, const cv::Mat& template_image, const cv::Mat& screen_image, double confidence = 0.9f, bool return_all = true)
+		{
+			if (!match_template(screen_image, template_image, result)) return false;
+			return auto_screen::find_img_from_result(img_postion, result, template_image.cols, template_image.rows, confidence, return_all);
+		}
+
+		/// <summary>
+		/// 获取参与匹配的线程总数
+		/// </summary>
+		/// <returns>线程总数</returns>
+		size_t thread_count() const { return pool.size(); }
+
+	private:
+		auto_thread_pool pool;
+
+		// 每个条带的BGR图像，跨调用复用
+		std::vector<cv::Mat> strip_images;
+		cv::Mat result;
+	};
+};//at
+
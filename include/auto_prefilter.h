@@ -0,0 +1,98 @@
+#pragma once
+#include <array>
+
+namespace at {
+	/// <summary>
+	/// 颜色直方图预筛选器，它为模板图片计算粗略的颜色签名，并为屏幕按图块统计颜色直方图。
+	/// 若模板的主要颜色在屏幕中的数量不足，就可以跳过耗时的matchTemplate，或只在数量足够的图块附近匹配
+	/// </summary>
+	class auto_prefilter
+	{
+	public:
+		using two_tuple = std::pair<int, int>;
+
+		/// B、G、R每个通道只取高2位，共64种颜色
+		static constexpr int bin_count = 64;
+
+		/// <summary>
+		/// 模板图片的颜色签名
+		/// </summary>
+		struct signature
+		{
+			std::array<uint32_t, bin_count> histogram = {};
+			/// 主要颜色的下标，只有前dominant_count个有效
+			std::array<uint8_t, bin_count> dominant_bins = {};
+			int dominant_count = 0;
+			int width = 0;
+			int height = 0;
+		};
+
+	public:
+		/// <summary>
+		/// 计算模板图片的颜色签名
+		/// </summary>
+		/// <param name="template_image">模板图片，BGR三通道</param>
+		/// <param name="dominant_ratio">占模板像素的比例不低于该值的颜色视为主要颜色，若没有这样的颜色，则取数量最多的颜色</param>
+		/// <returns>模板图片的颜色签名</returns>
+		static signature make_signature(const cv::Mat& template_image, double dominant_ratio = 0.1);
+
+		/// <summary>
+		/// 统计屏幕中每个图块的颜色直方图，每一帧只需要调用一次，之后可以用它筛选任意多个模板
+		/// </summary>
+		/// <param name="screen_image">屏幕矩阵，BGRA四通道</param>
+		/// <param name="tile_size">图块的边长，单位为像素</param>
+		/// <returns>操作是否成功，若屏幕为空或不是BGRA四通道，则返回false，之后的筛选也都返回false</returns>
+		bool build(const cv::Mat& screen_image, int tile_size = 32);
+
+		/// <summary>
+		/// 找出模板可能出现的区域，每个区域都已经包含模板的大小，可以直接在其中执行matchTemplate
+		/// </summary>
+		/// <param name="template_signature">模板图片的颜色签名</param>
+		/// <param name="regions">[out]返回模板可能出现的区域，它们的匹配结果互不重叠；区域的总面积超过屏幕的一半时，只返回整个屏幕一个区域</param>
+		/// <param name="required_ratio">区域中每种主要颜色的数量至少要达到模板中数量的多少倍，小于1可以容忍量化误差</param>
+		/// <returns>是否存在可能的区域，最近一次build成功时，返回false就可以直接认为模板不在屏幕上</returns>
+		bool candidate_regions(const signature& template_signature, std::vector<cv::Rect>& regions,
+			double required_ratio = 0.5) const;
+
+		/// <summary>
+		/// 先筛选出可能的区域，再只在这些区域中执行matchTemplate，得到的位置及其顺序与auto_screen::find_img_from_mat相同
+		/// </summary>
+		/// <param name="img_postion">[out]返回模板在屏幕矩阵中的位置，当函数返回true时，这个值才有意义</param>
+		/// <param name="template_image">模板图片，BGR三通道</param>
+		/// <param name="template_signature">模板图片的颜色签名</param>
+		/// <param name="screen_image">屏幕矩阵，BGRA四通道，必须是最近一次build所用的矩阵，大小不同时返回false</param>
+		/// <param name="confidence">至少需要的信心，它是一个0到1的值</param>
+		/// <returns>当信心小于指定值时，返回false，否则返回true</returns>
+		bool find_img_from_mat(std::vector<two_tuple>& img_postion, const cv::Mat& template_image,
+			const signature& template_signature, const cv::Mat& screen_image, double confidence = 0.9);
+
+		/// <summary>
+		/// 获取某个像素所属的颜色下标
+		/// </summary>
+		/// <param name="b">蓝色通道</param>
+		/// <param name="g">绿色通道</param>
+		/// <param name="r">红色通道</param>
+		/// <returns>颜色下标，范围为0到bin_count-1</returns>
+		static int color_bin(uchar b, uchar g, uchar r)
+		{
+			return (b >> 6) | ((g >> 6) << 2) | ((r >> 6) << 4);
+		}
+
+	private:
+		uint32_t _block_count(int bin, int left, int top, int right, int bottom) const;
+
+	private:
+		int tile_edge = 32;
+		int tiles_x = 0;
+		int tiles_y = 0;
+		int frame_width = 0;
+		int frame_height = 0;
+
+		// 每个图块每种颜色的二维前缀和，大小为(tiles_y + 1) * (tiles_x + 1) * bin_count，可以O(1)求任意图块矩形内的数量
+		std::vector<uint32_t> integral;
+		std::vector<cv::Rect> region_buffer;
+		cv::Mat region_image;
+		cv::Mat result;
+	};
+};//at
+
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <future>
+#include <thread>
+#include "auto_input.h"
+
+namespace at {
+	/// <summary>
+	/// 真实输入录制器，它在独立线程上通过低级键盘和鼠标钩子记录用户的真实输入，
+	/// 事件直接写入预先分配的缓冲区，录制结果可以转换为auto_input::execute_input_list能够回放的输入列表。
+	/// 同一时间只能有一个录制器在录制
+	/// </summary>
+	class auto_recorder
+	{
+	public:
+		enum class event_type :int {
+			/// 鼠标移动，x和y为屏幕坐标
+			mouse_move,
+			/// 鼠标按下，data为auto_input::mouse_button_type
+			mouse_down,
+			/// 鼠标弹起，data为auto_input::mouse_button_type
+			mouse_up,
+			/// 鼠标滚轮，data为滚动量
+			wheel,
+			/// 鼠标水平滚轮，data为滚动量
+			hwheel,
+			/// 键盘按下，data为虚拟键码
+			key_down,
+			/// 键盘弹起，data为虚拟键码
+			key_up
+		};
+
+		struct input_event
+		{
+			event_type type;
+			/// 事件发生的时间，单位为毫秒，与GetTickCount同源
+			DWORD time;
+			int x;
+			int y;
+			int data;
+		};
+
+	public:
+		/// <summary>
+		/// 构造录制器，并预先分配能容纳指定数量事件的缓冲区，录制期间不再分配内存
+		/// </summary>
+		/// <param name="capacity">最多能记录的事件数量，超出的事件会被丢弃并计数</param>
+		explicit auto_recorder(size_t capacity = 1 << 20) : buffer(capacity) {}
+		~auto_recorder() { stop(); }
+
+		auto_recorder(const auto_recorder&) = delete;
+		auto_recorder& operator=(const auto_recorder&) = delete;
+
+	public:
+		/// <summary>
+		/// 清空之前的录制结果并开始录制
+		/// </summary>
+		/// <param name="record_injected">是否也记录程序注入的输入，例如auto_input产生的输入，默认不记录</param>
+		/// <returns>操作是否成功，若已有录制器在录制或安装钩子失败，则返回false</returns>
+		bool start(bool record_injected = false);
+
+		/// <summary>
+		/// 停止录制
+		/// </summary>
+		void stop();
+
+		/// <summary>
+		/// 是否正在录制
+		/// </summary>
+		/// <returns>是否正在录制</returns>
+		bool is_recording() const { return hook_thread.joinable(); }
+
+		/// <summary>
+		/// 获取已经录制的事件，录制期间也可以调用
+		/// </summary>
+		/// <returns>已经录制的事件</returns>
+		std::vector<input_event> events() const
+		{
+			return std::vector<input_event>(buffer.begin(), buffer.begin() + event_count.load(std::memory_order_acquire));
+		}
+
+		/// <summary>
+		/// 获取因缓冲区已满而丢弃的事件数量
+		/// </summary>
+		/// <returns>丢弃的事件数量</returns>
+		size_t dropped_events() const { return dropped_count.load(std::memory_order_relaxed); }
+
+		/// <summary>
+		/// 将已经录制的事件转换为输入列表，事件之间的间隔转换为等待，可以交给auto_input::execute_input_list回放
+		/// </summary>
+		/// <returns>输入列表</returns>
+		auto_input::input_list to_input_list() const;
+
+	private:
+		static LRESULT CALLBACK _mouse_proc(int code, WPARAM w_param, LPARAM l_param);
+		static LRESULT CALLBACK _keyboard_proc(int code, WPARAM w_param, LPARAM l_param);
+		void _hook_loop(std::promise<bool>* started);
+		void _append(event_type type, DWORD time, int x, int y, int data);
+
+	private:
+		static std::atomic<auto_recorder*> active_recorder;
+
+		// 只由钩子线程写入，event_count以release发布，因此其他线程可以读取已发布的部分
+		std::vector<input_event> buffer;
+		std::atomic<size_t> event_count{ 0 };
+		std::atomic<size_t> dropped_count{ 0 };
+		bool with_injected = false;
+
+		std::thread hook_thread;
+		DWORD hook_thread_id = 0;
+	};
+};//at
+
@@ -16,16 +16,27 @@ namespace at {
 		/// </summary>
 		/// <returns>带有屏幕信息的位图图形对象的句柄</returns>
 		HBITMAP screen_slot()
+		{
+			return screen_slot(0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN));
+		}
+
+		/// <summary>
+		/// 给屏幕的指定区域截图，并返回其位图图形对象的句柄
+		/// </summary>
+		/// <param name="x">区域左上角相对于屏幕的x轴坐标</param>
+		/// <param name="y">区域左上角相对于屏幕的y轴坐标</param>
+		/// <param name="width">区域的宽度</param>
+		/// <param name="height">区域的高度</param>
+		/// <returns>带有该区域屏幕信息的位图图形对象的句柄</returns>
+		HBITMAP screen_slot(int x, int y, int width, int height)
 		{
 			HDC screen_handle = CreateDC(_T("DISPLAY"), NULL, NULL, NULL);
 			HDC	memory_handle = CreateCompatibleDC(screen_handle);
-			int	screen_width = GetSystemMetrics(SM_CXSCREEN);
-			int	screen_height = GetSystemMetrics(SM_CYSCREEN);
-			auto bitmap_handle = CreateCompatibleBitmap(screen_handle, screen_width, screen_height);
+			auto bitmap_handle = CreateCompatibleBitmap(screen_handle, width, height);
 			auto old_handle = (HBITMAP)SelectObject(memory_handle, bitmap_handle);
 
 			// 将屏幕数据传到位图中
-			BitBlt(memory_handle, 0, 0, screen_width, screen_height, screen_handle, 0, 0, SRCCOPY);
+			BitBlt(memory_handle, 0, 0, width, height, screen_handle, x, y, SRCCOPY);
 			SelectObject(memory_handle, old_handle);
 
 			DeleteDC(screen_handle);
@@ -39,17 +50,135 @@ namespace at {
 		/// <param name="bitmap">带有屏幕信息的位图图形对象的句柄</param>
 		/// <returns>带有屏幕信息的矩阵</returns>
 		cv::Mat bitmap_to_cv_mat(HBITMAP bitmap)
+		{
+			cv::Mat temp_mat;
+			bitmap_to_cv_mat(bitmap, temp_mat);
+			return temp_mat;
+		}
+
+		/// <summary>
+		/// 将位图句柄中的屏幕数据写入指定矩阵，若矩阵的大小和类型已经相符，则复用其内存而不重新分配
+		/// </summary>
+		/// <param name="bitmap">带有屏幕信息的位图图形对象的句柄</param>
+		/// <param name="screen_image">[out]接收屏幕信息的矩阵</param>
+		void bitmap_to_cv_mat(HBITMAP bitmap, cv::Mat& screen_image)
 		{
 			BITMAP bmp {0};
 			GetObject(bitmap, sizeof(BITMAP), &bmp);
 			int channels = bmp.bmBitsPixel == 1 ? 1 : bmp.bmBitsPixel / 8;
 
-			cv::Mat temp_mat;
-			temp_mat.create(bmp.bmHeight, bmp.bmWidth , CV_MAKETYPE(CV_8U, 4));
-			GetBitmapBits(bitmap, bmp.bmHeight * bmp.bmWidth * channels, temp_mat.data);
-			return temp_mat;
+			screen_image.create(bmp.bmHeight, bmp.bmWidth , CV_MAKETYPE(CV_8U, 4));
+			GetBitmapBits(bitmap, bmp.bmHeight * bmp.bmWidth * channels, screen_image.data);
+		}
+
+		/// <summary>
+		/// 获取屏幕上指定坐标的像素颜色，它只会截取该坐标处1x1大小的区域
+		/// </summary>
+		/// <param name="x">相对于屏幕的x轴坐标</param>
+		/// <param name="y">相对于屏幕的y轴坐标</param>
+		/// <returns>该像素的颜色，可以用GetRValue、GetGValue、GetBValue获取各个通道</returns>
+		COLORREF get_pixel(int x, int y)
+		{
+			auto bitmap_handle = screen_slot(x, y, 1, 1);
+			BYTE bgra[4] = { 0 };
+			GetBitmapBits(bitmap_handle, sizeof(bgra), bgra);
+			DeleteObject(bitmap_handle);
+			return RGB(bgra[2], bgra[1], bgra[0]);
+		}
+
+		/// <summary>
+		/// 判断屏幕上指定坐标的像素颜色是否与指定颜色相符
+		/// </summary>
+		/// <param name="x">相对于屏幕的x轴坐标</param>
+		/// <param name="y">相对于屏幕的y轴坐标</param>
+		/// <param name="color">指定颜色，可以用RGB宏构造</param>
+		/// <param name="tolerance">容差，R、G、B每个通道与指定颜色的差值都不超过该值时视为相符</param>
+		/// <returns>像素颜色是否与指定颜色相符</returns>
+		bool pixel_matches(int x, int y, COLORREF color, int tolerance = 0)
+		{
+			auto pixel = get_pixel(x, y);
+			return std::abs(GetRValue(pixel) - GetRValue(color)) <= tolerance &&
+				std::abs(GetGValue(pixel) - GetGValue(color)) <= tolerance &&
+				std::abs(GetBValue(pixel) - GetBValue(color)) <= tolerance;
+		}
+
+		/// <summary>
+		/// 在屏幕的指定区域中定位所有与指定颜色相符的像素
+		/// </summary>
+		/// <param name="color_postion">[out]返回所有相符像素的位置(相对于屏幕)</param>
+		/// <param name="x">区域左上角相对于屏幕的x轴坐标</param>
+		/// <param name="y">区域左上角相对于屏幕的y轴坐标</param>
+		/// <param name="width">区域的宽度</param>
+		/// <param name="height">区域的高度</param>
+		/// <param name="color">指定颜色，可以用RGB宏构造</param>
+		/// <param name="tolerance">容差，R、G、B每个通道与指定颜色的差值都不超过该值时视为相符</param>
+		/// <returns>是否找到至少一个相符的像素</returns>
+		bool find_color_from_region(std::vector<two_tuple>& color_postion, int x, int y, int width, int height,
+			COLORREF color, int tolerance = 0)
+		{
+			auto bitmap_handle = screen_slot(x, y, width, height);
+			auto region_image = bitmap_to_cv_mat(bitmap_handle);
+			DeleteObject(bitmap_handle);
+
+			return scan_color(region_image, color, tolerance, &color_postion, { x, y });
+		}
+
+		/// <summary>
+		/// 在整个屏幕中定位所有与指定颜色相符的像素
+		/// </summary>
+		/// <param name="color_postion">[out]返回所有相符像素的位置(相对于屏幕)</param>
+		/// <param name="color">指定颜色，可以用RGB宏构造</param>
+		/// <param name="tolerance">容差，R、G、B每个通道与指定颜色的差值都不超过该值时视为相符</param>
+		/// <returns>是否找到至少一个相符的像素</returns>
+		bool find_color_from_screen(std::vector<two_tuple>& color_postion, COLORREF color, int tolerance = 0)
+		{
+			return find_color_from_region(color_postion, 0, 0, GetSystemMetrics(SM_CXSCREEN),
+				GetSystemMetrics(SM_CYSCREEN), color, tolerance);
+		}
+
+		/// <summary>
+		/// 统计屏幕的指定区域中与指定颜色相符的像素数量
+		/// </summary>
+		/// <param name="x">区域左上角相对于屏幕的x轴坐标</param>
+		/// <param name="y">区域左上角相对于屏幕的y轴坐标</param>
+		/// <param name="width">区域的宽度</param>
+		/// <param name="height">区域的高度</param>
+		/// <param name="color">指定颜色，可以用RGB宏构造</param>
+		/// <param name="tolerance">容差，R、G、B每个通道与指定颜色的差值都不超过该值时视为相符</param>
+		/// <returns>相符像素的数量</returns>
+		size_t count_color_from_region(int x, int y, int width, int height, COLORREF color, int tolerance = 0)
+		{
+			auto bitmap_handle = screen_slot(x, y, width, height);
+			auto region_image = bitmap_to_cv_mat(bitmap_handle);
+			DeleteObject(bitmap_handle);
+
+			return scan_color(region_image, color, tolerance);
+		}
+
+		/// <summary>
+		/// 统计整个屏幕中与指定颜色相符的像素数量
+		/// </summary>
+		/// <param name="color">指定颜色，可以用RGB宏构造</param>
+		/// <param name="tolerance">容差，R、G、B每个通道与指定颜色的差值都不超过该值时视为相符</param>
+		/// <returns>相符像素的数量</returns>
+		size_t count_color_from_screen(COLORREF color, int tolerance = 0)
+		{
+			return count_color_from_region(0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN),
+				color, tolerance);
 		}
 
+		/// <summary>
+		/// 扫描BGRA矩阵，统计与指定颜色相符的像素，在支持SSE2的平台上每次比较4个像素
+		/// </summary>
+		/// <param name="bgra_image">CV_8UC4类型的矩阵，通常来自bitmap_to_cv_mat</param>
+		/// <param name="color">指定颜色，可以用RGB宏构造</param>
+		/// <param name="tolerance">容差，R、G、B每个通道与指定颜色的差值都不超过该值时视为相符，Alpha通道被忽略</param>
+		/// <param name="color_postion">[out]若不为空，则追加所有相符像素的位置</param>
+		/// <param name="offset">追加位置时加上的偏移量，用于将区域内坐标转换为屏幕坐标</param>
+		/// <returns>相符像素的数量</returns>
+		static size_t scan_color(const cv::Mat& bgra_image, COLORREF color, int tolerance,
+			std::vector<two_tuple>* color_postion = nullptr, two_tuple offset = { 0, 0 });
+
 		/// <summary>
 		/// 从屏幕中定位指定文件名的图片的位置，并将其返回，当信心小于指定值时，返回false，否则返回true
 		/// </summary>
@@ -59,38 +188,62 @@ namespace at {
 		/// <returns>当信心小于指定值时，返回false，否则返回true</returns>
 		bool find_img_from_screen(std::vector<two_tuple>& img_postion, const std::string& img_file_name, double confidence = 0.9f, bool return_all = true)
 		{
-			cv::Mat screen_image_3channel, result;
-
 			auto template_image = cv::imread(img_file_name);
-			
 
 			auto bitmap_handle = screen_slot();
 			auto screen_image = bitmap_to_cv_mat(bitmap_handle);
 
 			DeleteObject(bitmap_handle);
 
-			screen_image_3channel = screen_image;
+			return find_img_from_mat(img_postion, template_image, screen_image, confidence, return_all);
+		}
+
+		/// <summary>
+		/// 从已经截取的屏幕矩阵中定位指定图片的位置，例如来自auto_capture的帧，当信心小于指定值时，返回false，否则返回true
+		/// </summary>
+		/// <param name="img_postion">[out]返回指定图片在屏幕矩阵中的位置，当函数返回true时，这个值才有意义</param>
+		/// <param name="template_image">要定位的图片，BGR三通道</param>
+		/// <param name="screen_image">屏幕矩阵，BGRA四通道</param>
+		/// <param name="confidence">至少需要的信心，它是一个0到1的值</param>
+		/// <returns>当信心小于指定值时，返回false，否则返回true</returns>
+		bool find_img_from_mat(std::vector<two_tuple>& img_postion, const cv::Mat& template_image, const cv::Mat& screen_image, double confidence = 0.9f, bool return_all = true)
+		{
+			cv::Mat screen_image_3channel, result;
+
 			cv::cvtColor(screen_image, screen_image_3channel, 1);
 
 			int result_cols = screen_image_3channel.cols - template_image.cols + 1;
 			int result_rows = screen_image_3channel.rows - template_image.rows + 1;
-			result.create(result_cols, result_rows, CV_32FC1); 
+			result.create(result_rows, result_cols, CV_32FC1);
 
 			cv::matchTemplate(screen_image_3channel, template_image, result, cv::TemplateMatchModes::TM_SQDIFF_NORMED);
 			//cv::normalize(result, result, 0, 1, cv::NormTypes::NORM_MINMAX);
-			
 
+			return find_img_from_result(img_postion, result, template_image.cols, template_image.rows, confidence, return_all);
+		}
+
+		/// <summary>
+		/// 从TM_SQDIFF_NORMED的匹配结果中取出图片的位置，find_img_from_mat及其并行版本共用这一步，因此结果一致
+		/// </summary>
+		/// <param name="img_postion">[out]返回指定图片在屏幕矩阵中的位置，当函数返回true时，这个值才有意义</param>
+		/// <param name="result">matchTemplate得到的CV_32FC1矩阵</param>
+		/// <param name="template_cols">要定位的图片的宽度</param>
+		/// <param name="template_rows">要定位的图片的高度</param>
+		/// <param name="confidence">至少需要的信心，它是一个0到1的值</param>
+		/// <returns>当信心小于指定值时，返回false，否则返回true</returns>
+		static bool find_img_from_result(std::vector<two_tuple>& img_postion, const cv::Mat& result, int template_cols, int template_rows, double confidence = 0.9f, bool return_all = true)
+		{
 			double predict_confidence = 0;
 			cv::Point matched_point;
 			bool already_has_same_point_near = false;
 
-			static auto check_boundary = [&img_postion, &already_has_same_point_near, &template_image](int x, int y) {
+			auto check_boundary = [&img_postion, &already_has_same_point_near, template_cols, template_rows](int x, int y) {
 
 				for (auto iter = img_postion.rbegin(); iter != img_postion.rend(); ++iter)
 				{
-					int left = iter->first - template_image.cols;
+					int left = iter->first - template_cols;
 					int right = iter->first;
-					int top = iter->second - template_image.rows;
+					int top = iter->second - template_rows;
 					int bottom = iter->second;
 
 					if (right >= x && left <= x && top <= y && bottom >= y)
@@ -104,7 +257,7 @@ namespace at {
 			if (!return_all)
 			{
 				cv::minMaxLoc(result, &predict_confidence, nullptr, &matched_point);
-				img_postion.push_back({ matched_point.x + template_image.cols / 2 , matched_point.y + template_image.rows / 2 });
+				img_postion.push_back({ matched_point.x + template_cols / 2 , matched_point.y + template_rows / 2 });
 			}
 			else {
 				for (size_t x = 0; x < result.cols; ++x)
@@ -113,9 +266,9 @@ namespace at {
 						{
 							check_boundary(x, y);
 							if (!already_has_same_point_near)
-								img_postion.push_back({ x + template_image.cols / 2, y + template_image.rows / 2 });
+								img_postion.push_back({ x + template_cols / 2, y + template_rows / 2 });
 							already_has_same_point_near = false;
-							y += static_cast<size_t>(template_image.rows) - 1;
+							y += static_cast<size_t>(template_rows) - 1;
 						}
 			}
 			
@@ -123,6 +276,65 @@ namespace at {
 		}
 
 	};
+
+	/// <summary>
+	/// 连续截图用的截图器，它在整个生命周期内复用设备上下文和位图，只有屏幕分辨率改变时才重新创建位图
+	/// </summary>
+	class auto_screen_grabber
+	{
+	public:
+		auto_screen_grabber() = default;
+		~auto_screen_grabber()
+		{
+			if (bitmap_handle) DeleteObject(bitmap_handle);
+			if (memory_handle) DeleteDC(memory_handle);
+			if (screen_handle) DeleteDC(screen_handle);
+		}
+
+		auto_screen_grabber(const auto_screen_grabber&) = delete;
+		auto_screen_grabber& operator=(const auto_screen_grabber&) = delete;
+
+	public:
+		/// <summary>
+		/// 给整个屏幕截图，并写入指定矩阵
+		/// </summary>
+		/// <param name="screen_image">[out]BGRA四通道的屏幕矩阵，若其大小和类型已经相符，则复用其内存</param>
+		/// <returns>操作是否成功</returns>
+		bool grab(cv::Mat& screen_image)
+		{
+			if (!screen_handle)
+			{
+				screen_handle = CreateDC(_T("DISPLAY"), NULL, NULL, NULL);
+				memory_handle = CreateCompatibleDC(screen_handle);
+			}
+			if (!screen_handle || !memory_handle) return false;
+
+			int screen_width = GetSystemMetrics(SM_CXSCREEN);
+			int screen_height = GetSystemMetrics(SM_CYSCREEN);
+			if (!bitmap_handle || screen_width != bitmap_width || screen_height != bitmap_height)
+			{
+				if (bitmap_handle) DeleteObject(bitmap_handle);
+				bitmap_handle = CreateCompatibleBitmap(screen_handle, screen_width, screen_height);
+				bitmap_width = screen_width;
+				bitmap_height = screen_height;
+			}
+			if (!bitmap_handle) return false;
+
+			auto old_handle = (HBITMAP)SelectObject(memory_handle, bitmap_handle);
+			BitBlt(memory_handle, 0, 0, screen_width, screen_height, screen_handle, 0, 0, SRCCOPY);
+			SelectObject(memory_handle, old_handle);
+
+			auto_screen().bitmap_to_cv_mat(bitmap_handle, screen_image);
+			return true;
+		}
+
+	private:
+		HDC screen_handle = NULL;
+		HDC memory_handle = NULL;
+		HBITMAP bitmap_handle = NULL;
+		int bitmap_width = 0;
+		int bitmap_height = 0;
+	};
 };//at
 
 
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace at {
+	/// <summary>
+	/// 工作窃取线程池，每个线程有自己的任务队列，自己的任务做完后从其他线程的队列头部窃取任务，
+	/// 使耗时不均的任务也能让所有核心保持忙碌
+	/// </summary>
+	class auto_thread_pool
+	{
+	public:
+		/// <summary>
+		/// 创建线程池
+		/// </summary>
+		/// <param name="thread_count">参与执行任务的线程总数，包括调用run的线程，为0时取硬件线程数</param>
+		explicit auto_thread_pool(size_t thread_count = 0);
+		~auto_thread_pool();
+
+		auto_thread_pool(const auto_thread_pool&) = delete;
+		auto_thread_pool& operator=(const auto_thread_pool&) = delete;
+
+	public:
+		/// <summary>
+		/// 获取参与执行任务的线程总数，包括调用run的线程
+		/// </summary>
+		/// <returns>线程总数</returns>
+		size_t size() const { return queues.size(); }
+
+		/// <summary>
+		/// 执行一批任务并阻塞直到全部完成，调用线程也会参与执行。同一时间只能执行一批任务，并发调用会依次排队。
+		/// 若有任务抛出异常，其余任务照常执行，全部完成后在调用线程重新抛出第一个异常
+		/// </summary>
+		/// <param name="task_count">任务数量</param>
+		/// <param name="task">任务函数，参数为任务下标，从0到task_count-1</param>
+		void run(size_t task_count, const std::function<void(size_t)>& task);
+
+	private:
+		struct task_queue
+		{
+			std::mutex mutex;
+			std::deque<size_t> tasks;
+		};
+
+		bool _pop_or_steal(size_t queue_index, size_t& task_index);
+		void _drain(size_t queue_index);
+		void _worker_loop(size_t queue_index);
+
+	private:
+		// 最后一个队列属于调用run的线程
+		std::vector<std::unique_ptr<task_queue>> queues;
+		std::vector<std::thread> workers;
+
+		std::mutex run_mutex;
+		std::mutex state_mutex;
+		std::condition_variable start_cv;
+		std::condition_variable done_cv;
+		// 在分发任务之前写入，取到任务之后再读取，因此总能读到任务所属那一批的函数
+		std::atomic<const std::function<void(size_t)>*> current_task{ nullptr };
+		std::atomic<size_t> remaining_tasks{ 0 };
+		// 这一批任务中第一个抛出的异常，由state_mutex保护
+		std::exception_ptr first_exception;
+		uint64_t generation = 0;
+		bool stopping = false;
+	};
+};//at
+
@@ -1,4 +1,14 @@
 #pragma once
 
 #include "auto_input.h"
-#include "auto_screen.h"
\ No newline at end of file
+#include "auto_screen.h"
+#include "auto_capture.h"
+#include "auto_dispatcher.h"
+#include "auto_macro.h"
+#include "auto_tracker.h"
+#include "auto_recorder.h"
+#include "auto_frame_log.h"
+#include "auto_prefilter.h"
+#include "auto_thread_pool.h"
+#include "auto_parallel_match.h"
+#include "auto_matcher.h"
\ No newline at end of file
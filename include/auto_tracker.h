@@ -0,0 +1,94 @@
+#pragma once
+#include <chrono>
+
+namespace at {
+	/// <summary>
+	/// 图片跟踪器，它记住每个目标上一次的位置和速度，先在预测位置附近的小窗口中查找，
+	/// 只有信心不足时才扩大窗口，直至整个屏幕，使每帧的跟踪开销基本不随屏幕大小变化
+	/// </summary>
+	class auto_tracker
+	{
+	public:
+		using two_tuple = std::pair<int, int>;
+		using time_point = std::chrono::steady_clock::time_point;
+
+	public:
+		/// <summary>
+		/// 添加一个跟踪目标
+		/// </summary>
+		/// <param name="img_file_name">目标图片的文件名</param>
+		/// <param name="confidence">至少需要的信心，它是一个0到1的值</param>
+		/// <returns>目标的编号，读取图片失败时返回-1</returns>
+		int add_target(const std::string& img_file_name, double confidence = 0.9)
+		{
+			return add_target(cv::imread(img_file_name), confidence);
+		}
+
+		/// <summary>
+		/// 添加一个跟踪目标
+		/// </summary>
+		/// <param name="template_image">目标图片，BGR三通道</param>
+		/// <param name="confidence">至少需要的信心，它是一个0到1的值</param>
+		/// <returns>目标的编号，图片为空时返回-1</returns>
+		int add_target(const cv::Mat& template_image, double confidence = 0.9);
+
+		/// <summary>
+		/// 在新的一帧中更新目标的位置
+		/// </summary>
+		/// <param name="target_id">目标的编号</param>
+		/// <param name="screen_image">屏幕矩阵，BGRA四通道，例如auto_capture::frame::image</param>
+		/// <param name="img_postion">[out]目标中心在屏幕矩阵中的位置，当函数返回true时，这个值才有意义</param>
+		/// <param name="timestamp">这一帧的截图时间，用于估计目标的速度</param>
+		/// <returns>是否找到目标</returns>
+		bool update(int target_id, const cv::Mat& screen_image, two_tuple& img_postion,
+			time_point timestamp = std::chrono::steady_clock::now());
+
+		/// <summary>
+		/// 忘记目标的位置和速度，下一次更新时在整个屏幕中查找
+		/// </summary>
+		/// <param name="target_id">目标的编号</param>
+		void reset(int target_id);
+
+		/// <summary>
+		/// 设置预测窗口在目标图片四周额外留出的像素数，默认为32
+		/// </summary>
+		/// <param name="margin">额外留出的像素数</param>
+		void set_search_margin(int margin) { search_margin = margin > 0 ? margin : 1; }
+
+		/// <summary>
+		/// 获取指定目标在整个屏幕中查找的次数，用于观察预测窗口是否有效
+		/// </summary>
+		/// <param name="target_id">目标的编号</param>
+		/// <returns>在整个屏幕中查找的次数，编号无效时返回0</returns>
+		size_t full_frame_searches(int target_id) const
+		{
+			if (target_id < 0 || target_id >= static_cast<int>(targets.size())) return 0;
+			return targets[target_id].full_searches;
+		}
+
+	private:
+		struct target
+		{
+			cv::Mat template_image;
+			double confidence = 0.9;
+			bool has_position = false;
+			/// 目标中心的位置
+			double x = 0, y = 0;
+			/// 每秒移动的像素数
+			double velocity_x = 0, velocity_y = 0;
+			time_point last_time;
+			size_t full_searches = 0;
+		};
+
+		bool _match_in(const target& t, const cv::Mat& screen_image, const cv::Rect& window, cv::Point& matched_point);
+
+	private:
+		std::vector<target> targets;
+		int search_margin = 32;
+
+		// 每次匹配复用的工作区
+		cv::Mat window_image;
+		cv::Mat result;
+	};
+};//at
+
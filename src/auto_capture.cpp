@@ -0,0 +1,88 @@
+#include "stdafx.h"
+#include "auto_screen.h"
+#include "auto_capture.h"
+
+namespace at {
+	bool auto_capture::start(int frame_rate)
+	{
+		if (frame_rate <= 0 || running) return false;
+
+		running = true;
+		auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(1.0 / frame_rate));
+		capture_thread = std::thread(&auto_capture::_capture_loop, this, interval);
+		return true;
+	}
+
+	void auto_capture::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(wait_mutex);
+			running = false;
+		}
+		wait_cv.notify_all();
+
+		if (capture_thread.joinable())
+			capture_thread.join();
+	}
+
+	const auto_capture::frame& auto_capture::latest_frame()
+	{
+		// 只有中间缓冲有新帧时才交换，否则front中已经是最新的帧
+		if (middle_index.load(std::memory_order_relaxed) & fresh_bit)
+			front_index = middle_index.exchange(front_index, std::memory_order_acq_rel) & index_mask;
+		return frames[front_index];
+	}
+
+	const auto_capture::frame& auto_capture::wait_newer_frame(uint64_t sequence, int timeout_millisecond)
+	{
+		if (published_sequence.load(std::memory_order_acquire) <= sequence)
+		{
+			std::unique_lock<std::mutex> lock(wait_mutex);
+			auto has_newer = [this, sequence] {
+				return !running || published_sequence.load(std::memory_order_acquire) > sequence;
+			};
+
+			if (timeout_millisecond < 0)
+				wait_cv.wait(lock, has_newer);
+			else wait_cv.wait_for(lock, std::chrono::milliseconds(timeout_millisecond), has_newer);
+		}
+		return latest_frame();
+	}
+
+	void auto_capture::_capture_loop(std::chrono::steady_clock::duration interval)
+	{
+		auto_screen_grabber grabber;
+		auto next_time = std::chrono::steady_clock::now();
+		uint64_t sequence = published_sequence.load(std::memory_order_relaxed);
+
+		while (running)
+		{
+			// 截图失败时不发布，等下一次再试
+			auto& back = frames[back_index];
+			if (grabber.grab(back.image))
+			{
+				back.sequence = ++sequence;
+				back.timestamp = std::chrono::steady_clock::now();
+
+				// 发布新帧：把写好的back换到中间，同时拿回中间原来的缓冲继续写
+				back_index = middle_index.exchange(back_index | fresh_bit, std::memory_order_acq_rel) & index_mask;
+				{
+					std::lock_guard<std::mutex> lock(wait_mutex);
+					published_sequence.store(sequence, std::memory_order_release);
+				}
+				wait_cv.notify_all();
+			}
+
+			// 落后时不追赶，直接从当前时间重新计时，避免连续截图
+			next_time += interval;
+			auto now = std::chrono::steady_clock::now();
+			if (next_time < now) next_time = now;
+
+			std::unique_lock<std::mutex> lock(wait_mutex);
+			wait_cv.wait_until(lock, next_time, [this] { return !running; });
+		}
+	}
+
+};//at
+
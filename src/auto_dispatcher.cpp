@@ -0,0 +1,161 @@
+#include "stdafx.h"
+#include "auto_dispatcher.h"
+
+namespace at {
+	auto_dispatcher::auto_dispatcher()
+	{
+		// 队列中始终保留一个哑节点，使生产者与消费者不会同时修改同一个指针
+		queue_tail = new queue_node;
+		queue_head.store(queue_tail, std::memory_order_relaxed);
+	}
+
+	auto_dispatcher::~auto_dispatcher()
+	{
+		stop();
+		while (_pop()) {}
+		delete queue_tail;
+	}
+
+	bool auto_dispatcher::start()
+	{
+		if (running) return false;
+
+		running = true;
+		dispatch_thread = std::thread(&auto_dispatcher::_dispatch_loop, this);
+		return true;
+	}
+
+	void auto_dispatcher::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(wake_mutex);
+			running = false;
+			sleeping = false;
+		}
+		wake_cv.notify_one();
+
+		if (dispatch_thread.joinable())
+			dispatch_thread.join();
+
+		// 分发线程已经退出，此时由当前线程充当唯一的消费者，把队列中剩余的动作一并取消
+		while (auto state = _pop())
+			pending[0].push_back(std::move(state));
+
+		for (auto&& queue : pending)
+		{
+			for (auto&& state : queue)
+			{
+				auto expected = action_status::queued;
+				if (state->status.compare_exchange_strong(expected, action_status::cancelled))
+					state->promise.set_value(false);
+			}
+			queue.clear();
+		}
+	}
+
+	auto_dispatcher::action_handle auto_dispatcher::post(action_type action, priority_type priority)
+	{
+		auto state = std::make_shared<action_state>();
+		state->action = std::move(action);
+		state->priority = priority;
+
+		action_handle handle;
+		handle.result = state->promise.get_future();
+		handle.state = state;
+
+		auto node = new queue_node;
+		node->state = std::move(state);
+		_push(node);
+
+		// 只有分发线程声明自己要睡眠时才需要加锁唤醒，其余情况下提交动作不涉及任何锁
+		if (sleeping.exchange(false))
+		{
+			std::lock_guard<std::mutex> lock(wake_mutex);
+			wake_cv.notify_one();
+		}
+		return handle;
+	}
+
+	void auto_dispatcher::_push(queue_node* node)
+	{
+		auto prev = queue_head.exchange(node);
+		// 在这一步之前，消费者看不到node，_queue_empty会把这段间隙当作非空处理
+		prev->next.store(node, std::memory_order_release);
+	}
+
+	std::shared_ptr<auto_dispatcher::action_state> auto_dispatcher::_pop()
+	{
+		auto tail = queue_tail;
+		auto next = tail->next.load(std::memory_order_acquire);
+		if (!next) return nullptr;
+
+		// next成为新的哑节点，取走其中的动作
+		queue_tail = next;
+		auto state = std::move(next->state);
+		delete tail;
+		return state;
+	}
+
+	bool auto_dispatcher::_queue_empty() const
+	{
+		// 与post中对sleeping的交换一样使用顺序一致的内存序，保证分发线程睡眠前一定能看到已经提交的动作
+		return queue_head.load() == queue_tail;
+	}
+
+	void auto_dispatcher::_dispatch_loop()
+	{
+		auto_input input;
+
+		while (running)
+		{
+			while (auto state = _pop())
+			{
+				auto index = static_cast<size_t>(state->priority);
+				pending[index < 3 ? index : 2].push_back(std::move(state));
+			}
+
+			auto queue = std::find_if(std::begin(pending), std::end(pending),
+				[](const std::deque<std::shared_ptr<action_state>>& q) { return !q.empty(); });
+
+			if (queue != std::end(pending))
+			{
+				auto state = std::move(queue->front());
+				queue->pop_front();
+				_run_action(state, input);
+				continue;
+			}
+
+			if (!_queue_empty())
+			{
+				// 某个生产者正处于交换头指针与链接节点之间，稍等即可
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(wake_mutex);
+			sleeping = true;
+			if (!_queue_empty() || !running)
+			{
+				sleeping = false;
+				continue;
+			}
+			wake_cv.wait(lock, [this] { return !sleeping || !running; });
+		}
+	}
+
+	void auto_dispatcher::_run_action(const std::shared_ptr<action_state>& state, auto_input& input)
+	{
+		auto expected = action_status::queued;
+		if (!state->status.compare_exchange_strong(expected, action_status::running))
+			return;
+
+		try {
+			state->promise.set_value(state->action(input));
+		}
+		catch (...) {
+			state->promise.set_exception(std::current_exception());
+		}
+	}
+
+};//at
+
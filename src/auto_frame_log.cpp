@@ -0,0 +1,318 @@
+#include "stdafx.h"
+#include <lz4.h>
+#include "auto_frame_log.h"
+
+namespace at {
+	namespace {
+		// 文件头：magic、版本号、图块边长
+		// 每条记录：类型、帧序号、时间戳(纳秒)、宽、高、图块数量、[变化的图块下标]、原始大小、压缩后大小、压缩数据
+		constexpr char log_magic[4] = { 'A', 'T', 'F', 'L' };
+		constexpr uint32_t log_version = 1;
+
+		enum record_type : uint8_t {
+			keyframe_record,
+			delta_record
+		};
+
+		template<class T>
+		void write_value(std::ostream& os, const T& value)
+		{
+			os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		template<class T>
+		bool read_value(std::istream& is, T& value)
+		{
+			return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+		}
+
+		// 用64位计算，读取损坏的文件时宽高可能是任意值
+		uint64_t tile_count(int tile_edge, int cols, int rows)
+		{
+			return ((static_cast<int64_t>(cols) + tile_edge - 1) / tile_edge) * ((static_cast<int64_t>(rows) + tile_edge - 1) / tile_edge);
+		}
+
+		// 图块按行优先编号，右边和下边的图块可能不满一个边长
+		cv::Rect tile_rect(uint32_t index, int tile_edge, int cols, int rows)
+		{
+			int tiles_per_row = (cols + tile_edge - 1) / tile_edge;
+			int x = static_cast<int>(index % tiles_per_row) * tile_edge;
+			int y = static_cast<int>(index / tiles_per_row) * tile_edge;
+			return cv::Rect(x, y, std::min(tile_edge, cols - x), std::min(tile_edge, rows - y));
+		}
+
+		bool tile_equal(const cv::Mat& a, const cv::Mat& b, const cv::Rect& tile)
+		{
+			size_t row_bytes = static_cast<size_t>(tile.width) * 4;
+			for (int y = tile.y; y < tile.y + tile.height; ++y)
+				if (std::memcmp(a.ptr<uchar>(y) + tile.x * 4, b.ptr<uchar>(y) + tile.x * 4, row_bytes) != 0)
+					return false;
+			return true;
+		}
+
+		void append_tile(std::vector<char>& raw, const cv::Mat& image, const cv::Rect& tile)
+		{
+			size_t row_bytes = static_cast<size_t>(tile.width) * 4;
+			for (int y = tile.y; y < tile.y + tile.height; ++y)
+			{
+				auto row = reinterpret_cast<const char*>(image.ptr<uchar>(y) + tile.x * 4);
+				raw.insert(raw.end(), row, row + row_bytes);
+			}
+		}
+
+		void restore_tile(cv::Mat& image, const char*& source, const cv::Rect& tile)
+		{
+			size_t row_bytes = static_cast<size_t>(tile.width) * 4;
+			for (int y = tile.y; y < tile.y + tile.height; ++y)
+			{
+				std::memcpy(image.ptr<uchar>(y) + tile.x * 4, source, row_bytes);
+				source += row_bytes;
+			}
+		}
+	}
+
+	bool auto_frame_logger::open(const std::string& file_name, int tile_size, int keyframe_interval, size_t queue_capacity)
+	{
+		if (encode_thread.joinable() || tile_size <= 0 || keyframe_interval <= 0 || queue_capacity == 0) return false;
+
+		file.open(file_name, std::ios::binary | std::ios::trunc);
+		if (!file) return false;
+
+		tile_edge = tile_size;
+		keyframe_period = keyframe_interval;
+		file.write(log_magic, sizeof(log_magic));
+		write_value(file, log_version);
+		write_value(file, static_cast<uint32_t>(tile_edge));
+
+		slots.assign(queue_capacity, auto_capture::frame());
+		queue_head = queue_count = 0;
+		dropped_count = 0;
+		closing = false;
+		keyframe.release();
+		frames_since_keyframe = 0;
+
+		encode_thread = std::thread(&auto_frame_logger::_encode_loop, this);
+		return true;
+	}
+
+	void auto_frame_logger::close()
+	{
+		if (!encode_thread.joinable()) return;
+
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex);
+			closing = true;
+		}
+		queue_cv.notify_all();
+		encode_thread.join();
+		file.close();
+	}
+
+	bool auto_frame_logger::push(const auto_capture::frame& f)
+	{
+		if (f.image.empty() || f.image.type() != CV_8UC4) return false;
+
+		std::lock_guard<std::mutex> lock(queue_mutex);
+		if (slots.empty() || closing) return false;
+		if (queue_count == slots.size())
+		{
+			++dropped_count;
+			return false;
+		}
+
+		// 编码线程只读取已经计入queue_count的槽，所以这里可以在锁内直接写入空闲的槽
+		auto& slot = slots[(queue_head + queue_count) % slots.size()];
+		f.image.copyTo(slot.image);
+		slot.sequence = f.sequence;
+		slot.timestamp = f.timestamp;
+		++queue_count;
+		queue_cv.notify_one();
+		return true;
+	}
+
+	void auto_frame_logger::_encode_loop()
+	{
+		for (;;)
+		{
+			std::unique_lock<std::mutex> lock(queue_mutex);
+			queue_cv.wait(lock, [this] { return queue_count > 0 || closing; });
+			if (queue_count == 0) break;
+
+			auto& slot = slots[queue_head];
+			lock.unlock();
+
+			_encode(slot);
+
+			lock.lock();
+			queue_head = (queue_head + 1) % slots.size();
+			--queue_count;
+		}
+		file.flush();
+	}
+
+	void auto_frame_logger::_encode(const auto_capture::frame& f)
+	{
+		const cv::Mat& image = f.image;
+		const uint32_t total_tiles = static_cast<uint32_t>(tile_count(tile_edge, image.cols, image.rows));
+
+		bool is_keyframe = keyframe.empty() || keyframe.rows != image.rows || keyframe.cols != image.cols ||
+			frames_since_keyframe >= keyframe_period;
+
+		changed_tiles.clear();
+		if (!is_keyframe)
+		{
+			for (uint32_t i = 0; i < total_tiles; ++i)
+				if (!tile_equal(image, keyframe, tile_rect(i, tile_edge, image.cols, image.rows)))
+					changed_tiles.push_back(i);
+
+			// 变化超过一半时，写关键帧比写变化的图块更划算，也让之后的帧重新以它为基准
+			is_keyframe = changed_tiles.size() * 2 > total_tiles;
+		}
+
+		raw_buffer.clear();
+		if (is_keyframe)
+		{
+			image.copyTo(keyframe);
+			frames_since_keyframe = 0;
+			append_tile(raw_buffer, image, cv::Rect(0, 0, image.cols, image.rows));
+		}
+		else {
+			++frames_since_keyframe;
+			for (auto&& i : changed_tiles)
+				append_tile(raw_buffer, image, tile_rect(i, tile_edge, image.cols, image.rows));
+		}
+
+		int compressed_size = 0;
+		if (!raw_buffer.empty())
+		{
+			compressed_buffer.resize(LZ4_compressBound(static_cast<int>(raw_buffer.size())));
+			compressed_size = LZ4_compress_default(raw_buffer.data(), compressed_buffer.data(),
+				static_cast<int>(raw_buffer.size()), static_cast<int>(compressed_buffer.size()));
+
+			// 压缩失败时不写记录，这一帧算作丢弃；关键帧可能已经更新但没有写入文件，所以让下一帧重新写关键帧
+			if (compressed_size <= 0)
+			{
+				keyframe.release();
+				++dropped_count;
+				return;
+			}
+		}
+
+		write_value(file, static_cast<uint8_t>(is_keyframe ? keyframe_record : delta_record));
+		write_value(file, static_cast<uint64_t>(f.sequence));
+		write_value(file, static_cast<int64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(f.timestamp.time_since_epoch()).count()));
+		write_value(file, static_cast<int32_t>(image.cols));
+		write_value(file, static_cast<int32_t>(image.rows));
+		if (is_keyframe)
+			write_value(file, total_tiles);
+		else {
+			write_value(file, static_cast<uint32_t>(changed_tiles.size()));
+			file.write(reinterpret_cast<const char*>(changed_tiles.data()), changed_tiles.size() * sizeof(uint32_t));
+		}
+		write_value(file, static_cast<uint32_t>(raw_buffer.size()));
+		write_value(file, static_cast<uint32_t>(compressed_size));
+		file.write(compressed_buffer.data(), compressed_size);
+	}
+
+	bool auto_frame_replay::open(const std::string& file_name)
+	{
+		file.close();
+		file.clear();
+		file.open(file_name, std::ios::binary);
+
+		char magic[sizeof(log_magic)] = { 0 };
+		uint32_t version = 0, tile_size = 0;
+		if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, log_magic, sizeof(magic)) != 0 ||
+			!read_value(file, version) || version != log_version || !read_value(file, tile_size) || tile_size == 0)
+			return false;
+
+		tile_edge = static_cast<int>(tile_size);
+		first_record = file.tellg();
+		file.seekg(0, std::ios::end);
+		end_position = file.tellg();
+		file.seekg(first_record);
+		keyframe.release();
+		return true;
+	}
+
+	bool auto_frame_replay::rewind()
+	{
+		if (!file.is_open()) return false;
+
+		file.clear();
+		keyframe.release();
+		return static_cast<bool>(file.seekg(first_record));
+	}
+
+	bool auto_frame_replay::next_frame(auto_capture::frame& f)
+	{
+		uint8_t type = 0;
+		uint64_t sequence = 0;
+		int64_t timestamp = 0;
+		int32_t width = 0, height = 0;
+		uint32_t tiles = 0, raw_size = 0, compressed_size = 0;
+
+		if (!read_value(file, type) || !read_value(file, sequence) || !read_value(file, timestamp) ||
+			!read_value(file, width) || !read_value(file, height) || !read_value(file, tiles) ||
+			width <= 0 || height <= 0)
+			return false;
+
+		if (type == delta_record)
+		{
+			// 变化的图块总是相对于之前的关键帧，所以从文件中间开始回放是不行的
+			if (keyframe.rows != height || keyframe.cols != width) return false;
+			// 这些大小都直接来自文件，先检查是否合理，避免文件损坏时分配巨大的内存
+			if (tiles > tile_count(tile_edge, width, height) ||
+				static_cast<std::streamoff>(tiles) * 4 > end_position - file.tellg())
+				return false;
+			changed_tiles.resize(tiles);
+			if (!file.read(reinterpret_cast<char*>(changed_tiles.data()), tiles * sizeof(uint32_t)))
+				return false;
+		}
+		else if (type != keyframe_record) return false;
+
+		if (!read_value(file, raw_size) || !read_value(file, compressed_size)) return false;
+		// 宽高本身也可能损坏，所以压缩数据不能超过文件剩余的字节数，原始大小也不能超过LZ4最大255倍的压缩率
+		if (raw_size > static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * 4 ||
+			compressed_size > static_cast<uint32_t>(std::max(LZ4_compressBound(static_cast<int>(raw_size)), 0)) ||
+			compressed_size > end_position - file.tellg() ||
+			raw_size > static_cast<uint64_t>(compressed_size) * 255)
+			return false;
+
+		compressed_buffer.resize(compressed_size);
+		raw_buffer.resize(raw_size);
+		if (!file.read(compressed_buffer.data(), compressed_size)) return false;
+		if (raw_size > 0 && LZ4_decompress_safe(compressed_buffer.data(), raw_buffer.data(),
+			static_cast<int>(compressed_size), static_cast<int>(raw_size)) != static_cast<int>(raw_size))
+			return false;
+
+		const char* source = raw_buffer.data();
+		if (type == keyframe_record)
+		{
+			if (raw_size != static_cast<uint32_t>(width) * static_cast<uint32_t>(height) * 4) return false;
+			keyframe.create(height, width, CV_8UC4);
+			restore_tile(keyframe, source, cv::Rect(0, 0, width, height));
+			keyframe.copyTo(f.image);
+		}
+		else {
+			keyframe.copyTo(f.image);
+			const uint64_t total_tiles = tile_count(tile_edge, width, height);
+			const char* end = source + raw_size;
+			for (auto&& i : changed_tiles)
+			{
+				if (i >= total_tiles) return false;
+				auto tile = tile_rect(i, tile_edge, width, height);
+				if (end - source < static_cast<ptrdiff_t>(tile.area()) * 4) return false;
+				restore_tile(f.image, source, tile);
+			}
+		}
+
+		f.sequence = sequence;
+		f.timestamp = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::nanoseconds(timestamp)));
+		return true;
+	}
+
+};//at
+
@@ -0,0 +1,343 @@
+#include "stdafx.h"
+#include <sstream>
+#include <iomanip>
+#include "auto_macro.h"
+
+namespace at {
+	namespace {
+		bool parse_int(const std::string& word, int& value)
+		{
+			if (word.empty()) return false;
+			char* end = nullptr;
+			long result = std::strtol(word.c_str(), &end, 10);
+			if (*end != '\0') return false;
+			value = static_cast<int>(result);
+			return true;
+		}
+
+		bool parse_mouse_button(const std::string& word, int& button)
+		{
+			static const char* const button_names[] = {
+				"left", "right", "middle", "double_left", "double_right", "double_middle"
+			};
+
+			for (auto&& name : button_names)
+				if (word == name)
+				{
+					button = auto_input::enum_mapping(word).val;
+					return true;
+				}
+			return false;
+		}
+
+		// enum_mapping中还有鼠标按钮和点击方式的名字，它们的值不是虚拟键码，up、left这些名字容易被误当成方向键，必须排除
+		bool parse_key_name(const std::string& word, int& virtual_key)
+		{
+			static const char* const non_key_names[] = {
+				"left", "right", "middle", "double_left", "double_right", "double_middle", "down", "up", "up_and_down"
+			};
+
+			for (auto&& name : non_key_names)
+				if (word == name) return false;
+
+			virtual_key = auto_input::enum_mapping(word).val;
+			return virtual_key >= 0;
+		}
+
+		// 按美式键盘布局把字符解析为虚拟键码，需要按住shift才能输入的字符会把shift置为true
+		bool parse_typed_char(char c, WORD& virtual_key, bool& shift)
+		{
+			static const std::string shifted_chars = "~!@#$%^&*()_+{}|:\"<>?";
+			static const std::string base_chars = "`1234567890-=[]\\;',./";
+
+			shift = false;
+			auto shifted = shifted_chars.find(c);
+			if (shifted != std::string::npos)
+			{
+				shift = true;
+				c = base_chars[shifted];
+			}
+			else if (c >= 'A' && c <= 'Z')
+				shift = true;
+
+			if (c == ' ')
+				virtual_key = VK_SPACE;
+			else if (c == '=')
+				virtual_key = VK_OEM_PLUS;
+			else {
+				int val = auto_input::enum_mapping(std::string(1, c)).val;
+				if (val < 0) return false;
+				virtual_key = static_cast<WORD>(val);
+			}
+			return true;
+		}
+	}
+
+	bool auto_macro::compile(const std::string& source, std::string* error_message)
+	{
+		enum class block_type { loop, if_found, else_branch };
+		struct block
+		{
+			block_type type;
+			// 需要回填跳转目标的字节码下标
+			size_t patch_position;
+			// 循环体的起始位置
+			size_t body_position;
+		};
+
+		std::vector<int32_t> code;
+		std::vector<cv::Mat> new_templates;
+		std::vector<std::vector<typed_key>> new_texts;
+		std::vector<block> blocks;
+		size_t loop_depth = 0, new_max_loop_depth = 0;
+		size_t line_number = 0;
+
+		auto fail = [&](const std::string& message) {
+			if (error_message)
+				*error_message = "line " + std::to_string(line_number) + ": " + message;
+			return false;
+		};
+		auto emit = [&code](opcode op, std::initializer_list<int32_t> operands = {}) {
+			code.push_back(static_cast<int32_t>(op));
+			code.insert(code.end(), operands);
+		};
+
+		std::istringstream lines(source);
+		std::string line;
+		while (std::getline(lines, line))
+		{
+			++line_number;
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+
+			std::istringstream words(line);
+			std::string command, word;
+			if (!(words >> command) || command[0] == '#') continue;
+
+			std::vector<std::string> args;
+			while (words >> std::quoted(word))
+				args.push_back(word);
+
+			if (command == "move")
+			{
+				int x = 0, y = 0, millisecond_total = 100;
+				if (args.size() < 2 || args.size() > 3 || !parse_int(args[0], x) || !parse_int(args[1], y) ||
+					(args.size() == 3 && !parse_int(args[2], millisecond_total)))
+					return fail("usage: move x y [millisecond_total]");
+				emit(opcode::move_to, { x, y, millisecond_total });
+			}
+			else if (command == "click" || command == "click_found")
+			{
+				int button = static_cast<int>(auto_input::mouse_button_type::left);
+				size_t next = 0;
+				if (!args.empty() && parse_mouse_button(args[0], button))
+					next = 1;
+
+				if (command == "click_found")
+				{
+					if (next != args.size()) return fail("usage: click_found [button]");
+					emit(opcode::click_found, { button });
+					continue;
+				}
+
+				int x = 0, y = 0;
+				if (args.size() == next + 2 && parse_int(args[next], x) && parse_int(args[next + 1], y))
+					emit(opcode::move_to, { x, y, 100 });
+				else if (args.size() != next)
+					return fail("usage: click [button] [x y]");
+				emit(opcode::click, { button });
+			}
+			else if (command == "press")
+			{
+				if (args.empty()) return fail("usage: press name [name ...]");
+				for (auto&& name : args)
+				{
+					int virtual_key = 0;
+					if (!parse_key_name(name, virtual_key)) return fail("unknown key '" + name + "'");
+					emit(opcode::press, { virtual_key });
+				}
+			}
+			else if (command == "type")
+			{
+				// type之后的一个分隔符之后的内容原样输入，包括其中的空格
+				auto text_begin = line.find(command) + command.size() + 1;
+				std::vector<typed_key> keys;
+				for (size_t i = text_begin; i < line.size(); ++i)
+				{
+					typed_key key = { 0 };
+					if (!parse_typed_char(line[i], key.virtual_key, key.shift))
+						return fail(std::string("cannot type '") + line[i] + "'");
+					keys.push_back(key);
+				}
+				emit(opcode::type, { static_cast<int32_t>(new_texts.size()) });
+				new_texts.push_back(std::move(keys));
+			}
+			else if (command == "wait")
+			{
+				int millisecond = 0;
+				if (args.size() != 1 || !parse_int(args[0], millisecond) || millisecond < 0)
+					return fail("usage: wait millisecond");
+				emit(opcode::wait, { millisecond });
+			}
+			else if (command == "find")
+			{
+				double confidence = 0.9;
+				if (args.empty() || args.size() > 2)
+					return fail("usage: find file [confidence]");
+				if (args.size() == 2)
+				{
+					char* end = nullptr;
+					confidence = std::strtod(args[1].c_str(), &end);
+					if (*end != '\0' || confidence < 0 || confidence > 1)
+						return fail("confidence must be a number between 0 and 1");
+				}
+
+				auto template_image = cv::imread(args[0]);
+				if (template_image.empty()) return fail("cannot read image '" + args[0] + "'");
+
+				emit(opcode::find, { static_cast<int32_t>(new_templates.size()),
+					static_cast<int32_t>(confidence * 1000 + 0.5) });
+				new_templates.push_back(std::move(template_image));
+			}
+			else if (command == "if_found")
+			{
+				if (!args.empty()) return fail("usage: if_found");
+				emit(opcode::jump_if_not_found, { 0 });
+				blocks.push_back({ block_type::if_found, code.size() - 1, 0 });
+			}
+			else if (command == "else")
+			{
+				if (!args.empty() || blocks.empty() || blocks.back().type != block_type::if_found)
+					return fail("else without if_found");
+				emit(opcode::jump, { 0 });
+				code[blocks.back().patch_position] = static_cast<int32_t>(code.size());
+				blocks.back() = { block_type::else_branch, code.size() - 1, 0 };
+			}
+			else if (command == "loop")
+			{
+				int count = 0;
+				if (args.size() != 1 || !parse_int(args[0], count))
+					return fail("usage: loop count");
+				emit(opcode::loop_begin, { count, 0 });
+				blocks.push_back({ block_type::loop, code.size() - 1, code.size() });
+				new_max_loop_depth = std::max(new_max_loop_depth, ++loop_depth);
+			}
+			else if (command == "end")
+			{
+				if (!args.empty() || blocks.empty()) return fail("end without loop or if_found");
+
+				auto finished = blocks.back();
+				blocks.pop_back();
+				if (finished.type == block_type::loop)
+				{
+					emit(opcode::loop_end, { static_cast<int32_t>(finished.body_position) });
+					--loop_depth;
+				}
+				code[finished.patch_position] = static_cast<int32_t>(code.size());
+			}
+			else return fail("unknown command '" + command + "'");
+		}
+
+		if (!blocks.empty()) return fail("missing end");
+		emit(opcode::halt);
+
+		bytecode = std::move(code);
+		templates = std::move(new_templates);
+		texts = std::move(new_texts);
+		max_loop_depth = new_max_loop_depth;
+		loop_counters.reserve(max_loop_depth);
+		return true;
+	}
+
+	bool auto_macro::run(auto_input& input, auto_screen& screen)
+	{
+		if (bytecode.empty()) return false;
+
+		const int32_t* code = bytecode.data();
+		size_t pc = 0;
+		size_t steps = 0;
+		bool found = false;
+		bool is_ok = true;
+		loop_counters.clear();
+		found_postion.clear();
+
+		while (is_ok)
+		{
+			++steps;
+			switch (static_cast<opcode>(code[pc]))
+			{
+			case opcode::move_to:
+				is_ok = input.move_to(code[pc + 1], code[pc + 2], code[pc + 3]);
+				pc += 4;
+				break;
+			case opcode::click:
+				is_ok = input.click(auto_input::mouse_button_type(code[pc + 1]));
+				pc += 2;
+				break;
+			case opcode::click_found:
+				is_ok = found && input.click(found_postion.front().first, found_postion.front().second,
+					auto_input::mouse_button_type(code[pc + 1]));
+				pc += 2;
+				break;
+			case opcode::press:
+				is_ok = input.press(static_cast<WORD>(code[pc + 1]));
+				pc += 2;
+				break;
+			case opcode::type:
+				for (auto&& key : texts[code[pc + 1]])
+				{
+					if (key.shift)
+						is_ok = is_ok && input.key_down(VK_SHIFT) && input.press(key.virtual_key) && input.key_up(VK_SHIFT);
+					else is_ok = is_ok && input.press(key.virtual_key);
+				}
+				pc += 2;
+				break;
+			case opcode::wait:
+				is_ok = input.wait(code[pc + 1]);
+				pc += 2;
+				break;
+			case opcode::find:
+			{
+				auto bitmap_handle = screen.screen_slot();
+				screen.bitmap_to_cv_mat(bitmap_handle, screen_image);
+				DeleteObject(bitmap_handle);
+
+				found_postion.clear();
+				found = screen.find_img_from_mat(found_postion, templates[code[pc + 1]], screen_image,
+					code[pc + 2] / 1000.0);
+				pc += 3;
+				break;
+			}
+			case opcode::jump:
+				pc = code[pc + 1];
+				break;
+			case opcode::jump_if_not_found:
+				pc = found ? pc + 2 : code[pc + 1];
+				break;
+			case opcode::loop_begin:
+				if (code[pc + 1] > 0)
+				{
+					loop_counters.push_back(code[pc + 1]);
+					pc += 3;
+				}
+				else pc = code[pc + 2];
+				break;
+			case opcode::loop_end:
+				if (--loop_counters.back() > 0)
+					pc = code[pc + 1];
+				else {
+					loop_counters.pop_back();
+					pc += 2;
+				}
+				break;
+			case opcode::halt:
+				step_count = steps;
+				return true;
+			}
+		}
+
+		step_count = steps;
+		return false;
+	}
+
+};//at
+
@@ -0,0 +1,69 @@
+#include "stdafx.h"
+#include "auto_matcher.h"
+
+namespace at {
+	int auto_matcher::add_template(const cv::Mat& template_image)
+	{
+		if (template_image.empty() || template_image.type() != CV_8UC3) return -1;
+
+		templates.push_back(template_image);
+		// 新模板可能需要更大的结果矩阵，已经有屏幕大小时立即补足，避免在查找时分配
+		if (!screen_image_3channel.empty())
+			_reserve_result(screen_image_3channel.cols, screen_image_3channel.rows);
+		return static_cast<int>(templates.size() - 1);
+	}
+
+	void auto_matcher::reserve(int screen_width, int screen_height)
+	{
+		if (screen_width <= 0 || screen_height <= 0) return;
+
+		screen_frame.create(screen_height, screen_width, CV_8UC4);
+		screen_image_3channel.create(screen_height, screen_width, CV_8UC3);
+		_reserve_result(screen_width, screen_height);
+		// 达到信心的位置通常很少，先留一些余量，超过时vector按倍数增长，之后同样复用
+		postion.reserve(16);
+	}
+
+	void auto_matcher::_reserve_result(int screen_width, int screen_height)
+	{
+		size_t needed = 0;
+		for (auto&& t : templates)
+		{
+			if (t.cols > screen_width || t.rows > screen_height) continue;
+			needed = std::max(needed, static_cast<size_t>(screen_width - t.cols + 1) * (screen_height - t.rows + 1));
+		}
+
+		// 只增不减，在模板之间切换时不会反复分配
+		if (needed > result_buffer.total())
+			result_buffer.create(1, static_cast<int>(needed), CV_32FC1);
+	}
+
+	bool auto_matcher::find_img_from_screen(int template_id, double confidence, bool return_all)
+	{
+		// 分辨率改变时，find_img_from_mat会按新的大小补足工作区
+		if (!grabber.grab(screen_frame)) return false;
+		return find_img_from_mat(template_id, screen_frame, confidence, return_all);
+	}
+
+	bool auto_matcher::find_img_from_mat(int template_id, const cv::Mat& screen_image, double confidence, bool return_all)
+	{
+		postion.clear();
+		if (template_id < 0 || template_id >= static_cast<int>(templates.size()) || screen_image.empty()) return false;
+
+		const auto& template_image = templates[template_id];
+		int result_cols = screen_image.cols - template_image.cols + 1;
+		int result_rows = screen_image.rows - template_image.rows + 1;
+		if (result_cols <= 0 || result_rows <= 0) return false;
+
+		if (screen_image.cols != screen_image_3channel.cols || screen_image.rows != screen_image_3channel.rows)
+			_reserve_result(screen_image.cols, screen_image.rows);
+		cv::cvtColor(screen_image, screen_image_3channel, cv::COLOR_BGRA2BGR);
+
+		// 矩阵头只引用result_buffer的内存，大小和类型都与matchTemplate的输出相符，因此不会重新分配
+		cv::Mat result(result_rows, result_cols, CV_32FC1, result_buffer.data);
+		cv::matchTemplate(screen_image_3channel, template_image, result, cv::TemplateMatchModes::TM_SQDIFF_NORMED);
+		return auto_screen::find_img_from_result(postion, result, template_image.cols, template_image.rows, confidence, return_all);
+	}
+
+};//at
+
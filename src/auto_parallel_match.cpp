@@ -0,0 +1,40 @@
+#include "stdafx.h"
+#include "auto_parallel_match.h"
+
+namespace at {
+	bool auto_parallel_match::match_template(const cv::Mat& screen_image, const cv::Mat& template_image, cv::Mat& match_result)
+	{
+		// 类型不对时matchTemplate会在工作线程中抛出异常，先检查，与大小不对一样返回false
+		if (screen_image.empty() || template_image.empty() ||
+			screen_image.type() != CV_8UC4 || template_image.type() != CV_8UC3 ||
+			template_image.cols > screen_image.cols || template_image.rows > screen_image.rows)
+			return false;
+
+		const int result_rows = screen_image.rows - template_image.rows + 1;
+		const int result_cols = screen_image.cols - template_image.cols + 1;
+		match_result.create(result_rows, result_cols, CV_32FC1);
+
+		// 条带数是线程数的几倍，先做完的线程可以窃取剩下的条带；条带也不能太薄，否则重叠的行占比太大
+		constexpr int min_strip_rows = 16;
+		const size_t strip_count = std::max<size_t>(1,
+			std::min<size_t>(pool.size() * 4, static_cast<size_t>(result_rows / min_strip_rows)));
+		if (strip_images.size() < strip_count)
+			strip_images.resize(strip_count);
+
+		pool.run(strip_count, [&](size_t i) {
+			const int begin = static_cast<int>(result_rows * i / strip_count);
+			const int end = static_cast<int>(result_rows * (i + 1) / strip_count);
+
+			// 结果的第[begin, end)行需要屏幕的第[begin, end + 模板高度 - 1)行
+			cv::cvtColor(screen_image.rowRange(begin, end + template_image.rows - 1), strip_images[i], cv::COLOR_BGRA2BGR);
+
+			// 大小和类型相符时matchTemplate直接写入传入的子矩阵，各条带写入互不重叠的行
+			cv::Mat strip_result = match_result.rowRange(begin, end);
+			cv::matchTemplate(strip_images[i], template_image, strip_result, cv::TemplateMatchModes::TM_SQDIFF_NORMED);
+			if (strip_result.data != match_result.ptr<uchar>(begin))
+				strip_result.copyTo(match_result.rowRange(begin, end));
+		});
+		return true;
+	}
+
+};//at
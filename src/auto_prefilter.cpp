@@ -0,0 +1,188 @@
+#include "stdafx.h"
+#include "auto_screen.h"
+#include "auto_prefilter.h"
+
+namespace at {
+	auto_prefilter::signature auto_prefilter::make_signature(const cv::Mat& template_image, double dominant_ratio)
+	{
+		signature result;
+		if (template_image.empty() || template_image.type() != CV_8UC3) return result;
+
+		result.width = template_image.cols;
+		result.height = template_image.rows;
+		for (int y = 0; y < template_image.rows; ++y)
+		{
+			const uchar* row = template_image.ptr<uchar>(y);
+			for (int x = 0; x < template_image.cols; ++x, row += 3)
+				++result.histogram[color_bin(row[0], row[1], row[2])];
+		}
+
+		auto threshold = dominant_ratio * template_image.total();
+		int most_bin = 0;
+		for (int i = 0; i < bin_count; ++i)
+		{
+			if (result.histogram[i] >= threshold)
+				result.dominant_bins[result.dominant_count++] = static_cast<uint8_t>(i);
+			if (result.histogram[i] > result.histogram[most_bin])
+				most_bin = i;
+		}
+
+		if (result.dominant_count == 0)
+			result.dominant_bins[result.dominant_count++] = static_cast<uint8_t>(most_bin);
+		return result;
+	}
+
+	bool auto_prefilter::build(const cv::Mat& screen_image, int tile_size)
+	{
+		// 不能统计的屏幕不留下全为0的直方图，否则之后的筛选会把出错当成模板不在屏幕上
+		if (screen_image.empty() || screen_image.type() != CV_8UC4)
+		{
+			integral.clear();
+			frame_width = frame_height = tiles_x = tiles_y = 0;
+			return false;
+		}
+
+		tile_edge = tile_size > 0 ? tile_size : 32;
+		frame_width = screen_image.cols;
+		frame_height = screen_image.rows;
+		tiles_x = (frame_width + tile_edge - 1) / tile_edge;
+		tiles_y = (frame_height + tile_edge - 1) / tile_edge;
+
+		const size_t stride = static_cast<size_t>(tiles_x + 1) * bin_count;
+		integral.assign(stride * (tiles_y + 1), 0);
+
+		// 先把每个图块的直方图写到前缀和中对应的(ty + 1, tx + 1)位置
+		for (int y = 0; y < frame_height; ++y)
+		{
+			const uchar* row = screen_image.ptr<uchar>(y);
+			uint32_t* tile_row = integral.data() + (y / tile_edge + 1) * stride;
+			for (int x = 0; x < frame_width; ++x, row += 4)
+				++tile_row[(x / tile_edge + 1) * bin_count + color_bin(row[0], row[1], row[2])];
+		}
+
+		// 再原地累加成二维前缀和
+		for (int ty = 1; ty <= tiles_y; ++ty)
+			for (int tx = 1; tx <= tiles_x; ++tx)
+			{
+				uint32_t* cell = integral.data() + ty * stride + tx * bin_count;
+				const uint32_t* up = cell - stride;
+				const uint32_t* left = cell - bin_count;
+				const uint32_t* up_left = up - bin_count;
+				for (int b = 0; b < bin_count; ++b)
+					cell[b] += up[b] + left[b] - up_left[b];
+			}
+		return true;
+	}
+
+	uint32_t auto_prefilter::_block_count(int bin, int left, int top, int right, int bottom) const
+	{
+		const size_t stride = static_cast<size_t>(tiles_x + 1) * bin_count;
+		auto cell = [&](int tx, int ty) { return integral[ty * stride + tx * bin_count + bin]; };
+		return cell(right, bottom) - cell(left, bottom) - cell(right, top) + cell(left, top);
+	}
+
+	bool auto_prefilter::candidate_regions(const signature& template_signature, std::vector<cv::Rect>& regions,
+		double required_ratio) const
+	{
+		regions.clear();
+		const int template_width = template_signature.width;
+		const int template_height = template_signature.height;
+		if (integral.empty() || template_width <= 0 || template_height <= 0 ||
+			template_width > frame_width || template_height > frame_height)
+			return false;
+
+		const cv::Rect frame_rect(0, 0, frame_width, frame_height);
+		// 左上角落在某个图块内的模板，最多覆盖从该图块开始的这么多个图块
+		const int block_width = (tile_edge + template_width - 2) / tile_edge + 1;
+		const int block_height = (tile_edge + template_height - 2) / tile_edge + 1;
+		// 左上角超过这里的位置放不下模板
+		const int last_tx = (frame_width - template_width) / tile_edge;
+		const int last_ty = (frame_height - template_height) / tile_edge;
+
+		// 上一行和这一行结束的区域在regions中的下标，都按x排序；区域在循环中先不裁剪，最后统一裁剪到屏幕内
+		std::vector<size_t> previous_open, current_open;
+		for (int ty = 0; ty <= last_ty; ++ty)
+		{
+			size_t previous_index = 0;
+			int run_begin = -1;
+			for (int tx = 0; tx <= last_tx + 1; ++tx)
+			{
+				bool is_candidate = tx <= last_tx;
+				for (int i = 0; is_candidate && i < template_signature.dominant_count; ++i)
+				{
+					int bin = template_signature.dominant_bins[i];
+					auto count = _block_count(bin, tx, ty,
+						std::min(tx + block_width, tiles_x), std::min(ty + block_height, tiles_y));
+					is_candidate = count >= required_ratio * template_signature.histogram[bin];
+				}
+
+				// 把同一行中相邻的候选图块合并为一个区域，减少matchTemplate的调用次数
+				if (is_candidate && run_begin < 0)
+					run_begin = tx;
+				else if (!is_candidate && run_begin >= 0)
+				{
+					cv::Rect region(run_begin * tile_edge, ty * tile_edge,
+						(tx - run_begin) * tile_edge + template_width - 1, tile_edge + template_height - 1);
+
+					// 上一行中左右范围相同的区域直接向下延长一个图块，否则上下相邻的区域会重复处理模板高度减1行
+					while (previous_index < previous_open.size() && regions[previous_open[previous_index]].x < region.x)
+						++previous_index;
+					if (previous_index < previous_open.size() && regions[previous_open[previous_index]].x == region.x &&
+						regions[previous_open[previous_index]].width == region.width)
+					{
+						regions[previous_open[previous_index]].height += tile_edge;
+						current_open.push_back(previous_open[previous_index]);
+					}
+					else {
+						current_open.push_back(regions.size());
+						regions.push_back(region);
+					}
+					run_begin = -1;
+				}
+			}
+			previous_open.swap(current_open);
+			current_open.clear();
+		}
+
+		int region_area = 0;
+		for (auto&& region : regions)
+		{
+			region &= frame_rect;
+			region_area += region.area();
+		}
+
+		// 候选区域太多时，分块匹配的额外开销会超过节省的部分，直接在整个屏幕中匹配
+		if (region_area > frame_rect.area() / 2)
+			regions.assign(1, frame_rect);
+		return !regions.empty();
+	}
+
+	bool auto_prefilter::find_img_from_mat(std::vector<two_tuple>& img_postion, const cv::Mat& template_image,
+		const signature& template_signature, const cv::Mat& screen_image, double confidence)
+	{
+		// 区域是按build时的屏幕大小算出的，大小不同的屏幕上取子矩阵会越界
+		if (screen_image.cols != frame_width || screen_image.rows != frame_height || screen_image.type() != CV_8UC4 ||
+			template_image.cols > screen_image.cols || template_image.rows > screen_image.rows ||
+			!candidate_regions(template_signature, region_buffer))
+			return false;
+
+		// 各区域的匹配结果写入同一个与整个屏幕匹配时大小相同的矩阵，其余位置填1，即完全不相似，
+		// 这样最后只取一次位置，去重和顺序都与auto_screen::find_img_from_mat相同
+		result.create(screen_image.rows - template_image.rows + 1, screen_image.cols - template_image.cols + 1, CV_32FC1);
+		result.setTo(cv::Scalar(1));
+		for (auto&& region : region_buffer)
+		{
+			cv::cvtColor(screen_image(region), region_image, cv::COLOR_BGRA2BGR);
+
+			// 大小和类型相符时matchTemplate直接写入传入的子矩阵
+			cv::Rect result_rect(region.x, region.y, region.width - template_image.cols + 1, region.height - template_image.rows + 1);
+			cv::Mat region_result = result(result_rect);
+			cv::matchTemplate(region_image, template_image, region_result, cv::TemplateMatchModes::TM_SQDIFF_NORMED);
+			if (region_result.data != result.ptr<uchar>(region.y) + region.x * sizeof(float))
+				region_result.copyTo(result(result_rect));
+		}
+		return auto_screen::find_img_from_result(img_postion, result, template_image.cols, template_image.rows, confidence);
+	}
+
+};//at
+
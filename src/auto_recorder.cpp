@@ -0,0 +1,187 @@
+#include "stdafx.h"
+#include "auto_recorder.h"
+
+namespace at {
+	std::atomic<auto_recorder*> auto_recorder::active_recorder{ nullptr };
+
+	bool auto_recorder::start(bool record_injected)
+	{
+		if (is_recording()) return false;
+
+		// 低级钩子的回调是静态函数，只能通过全局指针找到录制器
+		auto_recorder* expected = nullptr;
+		if (!active_recorder.compare_exchange_strong(expected, this)) return false;
+
+		event_count.store(0, std::memory_order_relaxed);
+		dropped_count.store(0, std::memory_order_relaxed);
+		with_injected = record_injected;
+
+		std::promise<bool> started;
+		auto started_result = started.get_future();
+		hook_thread = std::thread(&auto_recorder::_hook_loop, this, &started);
+
+		if (!started_result.get())
+		{
+			hook_thread.join();
+			active_recorder = nullptr;
+			return false;
+		}
+		return true;
+	}
+
+	void auto_recorder::stop()
+	{
+		if (!is_recording()) return;
+
+		PostThreadMessage(hook_thread_id, WM_QUIT, 0, 0);
+		hook_thread.join();
+		active_recorder = nullptr;
+	}
+
+	void auto_recorder::_hook_loop(std::promise<bool>* started)
+	{
+		// 先创建线程的消息队列，保证stop发出的WM_QUIT不会丢失
+		MSG msg;
+		PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+		hook_thread_id = GetCurrentThreadId();
+
+		HINSTANCE instance = GetModuleHandle(NULL);
+		HHOOK mouse_hook = SetWindowsHookEx(WH_MOUSE_LL, _mouse_proc, instance, 0);
+		HHOOK keyboard_hook = SetWindowsHookEx(WH_KEYBOARD_LL, _keyboard_proc, instance, 0);
+
+		bool is_succeed = mouse_hook && keyboard_hook;
+		started->set_value(is_succeed);
+
+		// 低级钩子的回调在安装钩子的线程的消息循环中执行
+		while (is_succeed && GetMessage(&msg, NULL, 0, 0) > 0)
+		{
+			TranslateMessage(&msg);
+			DispatchMessage(&msg);
+		}
+
+		if (mouse_hook) UnhookWindowsHookEx(mouse_hook);
+		if (keyboard_hook) UnhookWindowsHookEx(keyboard_hook);
+	}
+
+	void auto_recorder::_append(event_type type, DWORD time, int x, int y, int data)
+	{
+		auto index = event_count.load(std::memory_order_relaxed);
+		if (index >= buffer.size())
+		{
+			dropped_count.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		buffer[index] = { type, time, x, y, data };
+		event_count.store(index + 1, std::memory_order_release);
+	}
+
+	LRESULT CALLBACK auto_recorder::_mouse_proc(int code, WPARAM w_param, LPARAM l_param)
+	{
+		auto recorder = active_recorder.load(std::memory_order_acquire);
+		auto info = reinterpret_cast<const MSLLHOOKSTRUCT*>(l_param);
+
+		if (code == HC_ACTION && recorder && (recorder->with_injected || !(info->flags & LLMHF_INJECTED)))
+		{
+			auto wheel_delta = static_cast<int>(static_cast<short>(HIWORD(info->mouseData)));
+			auto append = [recorder, info](event_type type, int data) {
+				recorder->_append(type, info->time, info->pt.x, info->pt.y, data);
+			};
+
+			switch (w_param)
+			{
+			case WM_MOUSEMOVE: append(event_type::mouse_move, 0); break;
+			case WM_LBUTTONDOWN: append(event_type::mouse_down, (int)auto_input::mouse_button_type::left); break;
+			case WM_LBUTTONUP: append(event_type::mouse_up, (int)auto_input::mouse_button_type::left); break;
+			case WM_RBUTTONDOWN: append(event_type::mouse_down, (int)auto_input::mouse_button_type::right); break;
+			case WM_RBUTTONUP: append(event_type::mouse_up, (int)auto_input::mouse_button_type::right); break;
+			case WM_MBUTTONDOWN: append(event_type::mouse_down, (int)auto_input::mouse_button_type::middle); break;
+			case WM_MBUTTONUP: append(event_type::mouse_up, (int)auto_input::mouse_button_type::middle); break;
+			case WM_MOUSEWHEEL: append(event_type::wheel, wheel_delta); break;
+			case WM_MOUSEHWHEEL: append(event_type::hwheel, wheel_delta); break;
+			}
+		}
+		return CallNextHookEx(NULL, code, w_param, l_param);
+	}
+
+	LRESULT CALLBACK auto_recorder::_keyboard_proc(int code, WPARAM w_param, LPARAM l_param)
+	{
+		auto recorder = active_recorder.load(std::memory_order_acquire);
+		auto info = reinterpret_cast<const KBDLLHOOKSTRUCT*>(l_param);
+
+		if (code == HC_ACTION && recorder && (recorder->with_injected || !(info->flags & LLKHF_INJECTED)))
+		{
+			switch (w_param)
+			{
+			case WM_KEYDOWN:
+			case WM_SYSKEYDOWN:
+				recorder->_append(event_type::key_down, info->time, 0, 0, static_cast<int>(info->vkCode));
+				break;
+			case WM_KEYUP:
+			case WM_SYSKEYUP:
+				recorder->_append(event_type::key_up, info->time, 0, 0, static_cast<int>(info->vkCode));
+				break;
+			}
+		}
+		return CallNextHookEx(NULL, code, w_param, l_param);
+	}
+
+	auto_input::input_list auto_recorder::to_input_list() const
+	{
+		auto recorded = events();
+		auto_input::input_list il;
+		il.reserve(recorded.size() * 2);
+
+		static const DWORD down_flags[] = { MOUSEEVENTF_LEFTDOWN, MOUSEEVENTF_RIGHTDOWN, MOUSEEVENTF_MIDDLEDOWN };
+		static const DWORD up_flags[] = { MOUSEEVENTF_LEFTUP, MOUSEEVENTF_RIGHTUP, MOUSEEVENTF_MIDDLEUP };
+
+		DWORD last_time = recorded.empty() ? 0 : recorded.front().time;
+		for (auto&& e : recorded)
+		{
+			// 无符号相减，GetTickCount回绕时也能得到正确的间隔
+			DWORD interval = e.time - last_time;
+			last_time = e.time;
+			if (interval > 0)
+			{
+				INPUT wait_input = { 0 };
+				wait_input.type = auto_input::wait_sign;
+				wait_input.mi.dx = interval;
+				il.push_back(wait_input);
+			}
+
+			INPUT temp_input = { 0 };
+			switch (e.type)
+			{
+			case event_type::mouse_move:
+			{
+				auto point = mw::user::trans_screen_to_absolute(e.x, e.y);
+				mw::user::write_mouse_event(&temp_input, point.first, point.second,
+					MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK);
+				break;
+			}
+			case event_type::mouse_down:
+				mw::user::write_mouse_event(&temp_input, 0, 0, down_flags[e.data]);
+				break;
+			case event_type::mouse_up:
+				mw::user::write_mouse_event(&temp_input, 0, 0, up_flags[e.data]);
+				break;
+			case event_type::wheel:
+				mw::user::write_mouse_event(&temp_input, 0, 0, MOUSEEVENTF_WHEEL, e.data);
+				break;
+			case event_type::hwheel:
+				mw::user::write_mouse_event(&temp_input, 0, 0, MOUSEEVENTF_HWHEEL, e.data);
+				break;
+			case event_type::key_down:
+				mw::user::write_keyboard_event(&temp_input, static_cast<WORD>(e.data), 0, 0);
+				break;
+			case event_type::key_up:
+				mw::user::write_keyboard_event(&temp_input, static_cast<WORD>(e.data), KEYEVENTF_KEYUP, 0);
+				break;
+			}
+			il.push_back(temp_input);
+		}
+		return il;
+	}
+
+};//at
+
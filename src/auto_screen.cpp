@@ -1,2 +1,77 @@
 #include "stdafx.h"
 #include "auto_screen.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define AT_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace at {
+	namespace {
+		// 4个像素比较结果的掩码对应的相符像素数量
+		constexpr int mask_popcount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+		inline bool pixel_in_tolerance(const uchar* pixel, const uchar* target, int tolerance)
+		{
+			return std::abs(pixel[0] - target[0]) <= tolerance &&
+				std::abs(pixel[1] - target[1]) <= tolerance &&
+				std::abs(pixel[2] - target[2]) <= tolerance;
+		}
+	}
+
+	size_t auto_screen::scan_color(const cv::Mat& bgra_image, COLORREF color, int tolerance,
+		std::vector<two_tuple>* color_postion, two_tuple offset)
+	{
+		if (bgra_image.empty() || bgra_image.type() != CV_8UC4 || tolerance < 0) return 0;
+		if (tolerance > 255) tolerance = 255;
+
+		const uchar target[4] = { GetBValue(color), GetGValue(color), GetRValue(color), 0 };
+		size_t matched = 0;
+
+#ifdef AT_USE_SSE2
+		// 每个像素占4字节，一个128位寄存器正好装下4个像素
+		// Alpha通道的容差设为255，使它在饱和减法后恒为0，相当于忽略Alpha
+		const __m128i target_vec = _mm_set1_epi32(static_cast<int>(
+			target[0] | (target[1] << 8) | (target[2] << 16)));
+		const __m128i tolerance_vec = _mm_set1_epi32(static_cast<int>(
+			tolerance | (tolerance << 8) | (tolerance << 16) | (0xFFu << 24)));
+		const __m128i zero = _mm_setzero_si128();
+#endif
+
+		for (int y = 0; y < bgra_image.rows; ++y)
+		{
+			const uchar* row = bgra_image.ptr<uchar>(y);
+			int x = 0;
+
+#ifdef AT_USE_SSE2
+			for (; x + 4 <= bgra_image.cols; x += 4)
+			{
+				__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 4));
+				// 无符号字节的绝对差 = 两个方向饱和减法的或
+				__m128i diff = _mm_or_si128(_mm_subs_epu8(pixels, target_vec), _mm_subs_epu8(target_vec, pixels));
+				__m128i over = _mm_subs_epu8(diff, tolerance_vec);
+				int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(over, zero)));
+				if (!mask) continue;
+
+				matched += mask_popcount[mask];
+				if (color_postion)
+					for (int i = 0; i < 4; ++i)
+						if (mask & (1 << i))
+							color_postion->push_back({ offset.first + x + i, offset.second + y });
+			}
+#endif
+
+			for (; x < bgra_image.cols; ++x)
+			{
+				if (!pixel_in_tolerance(row + x * 4, target, tolerance)) continue;
+
+				++matched;
+				if (color_postion)
+					color_postion->push_back({ offset.first + x, offset.second + y });
+			}
+		}
+
+		return matched;
+	}
+
+};//at
@@ -0,0 +1,129 @@
+#include "stdafx.h"
+#include "auto_thread_pool.h"
+
+namespace at {
+	auto_thread_pool::auto_thread_pool(size_t thread_count)
+	{
+		if (thread_count == 0) thread_count = std::thread::hardware_concurrency();
+		if (thread_count == 0) thread_count = 1;
+
+		for (size_t i = 0; i < thread_count; ++i)
+			queues.push_back(std::make_unique<task_queue>());
+		for (size_t i = 0; i + 1 < thread_count; ++i)
+			workers.emplace_back(&auto_thread_pool::_worker_loop, this, i);
+	}
+
+	auto_thread_pool::~auto_thread_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(state_mutex);
+			stopping = true;
+		}
+		start_cv.notify_all();
+
+		for (auto&& t : workers)
+			t.join();
+	}
+
+	void auto_thread_pool::run(size_t task_count, const std::function<void(size_t)>& task)
+	{
+		if (task_count == 0) return;
+
+		std::lock_guard<std::mutex> run_lock(run_mutex);
+		remaining_tasks = task_count;
+		current_task = &task;
+
+		// 把任务按连续的块平均分给每个队列，相邻的任务通常访问相邻的数据
+		const size_t queue_count = queues.size();
+		for (size_t q = 0; q < queue_count; ++q)
+		{
+			std::lock_guard<std::mutex> lock(queues[q]->mutex);
+			for (size_t i = task_count * q / queue_count; i < task_count * (q + 1) / queue_count; ++i)
+				queues[q]->tasks.push_back(i);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(state_mutex);
+			++generation;
+		}
+		start_cv.notify_all();
+
+		_drain(queue_count - 1);
+
+		std::unique_lock<std::mutex> lock(state_mutex);
+		done_cv.wait(lock, [this] { return remaining_tasks == 0; });
+		current_task = nullptr;
+
+		// 所有任务都结束后才重新抛出，此时不再有线程引用task，线程池也可以继续使用
+		if (first_exception)
+			std::rethrow_exception(std::exchange(first_exception, nullptr));
+	}
+
+	bool auto_thread_pool::_pop_or_steal(size_t queue_index, size_t& task_index)
+	{
+		// 自己的队列从尾部取，其他队列从头部偷，两端各自操作，减少争用
+		{
+			auto& own = *queues[queue_index];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if (!own.tasks.empty())
+			{
+				task_index = own.tasks.back();
+				own.tasks.pop_back();
+				return true;
+			}
+		}
+
+		for (size_t offset = 1; offset < queues.size(); ++offset)
+		{
+			auto& victim = *queues[(queue_index + offset) % queues.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.tasks.empty())
+			{
+				task_index = victim.tasks.front();
+				victim.tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void auto_thread_pool::_drain(size_t queue_index)
+	{
+		size_t task_index = 0;
+		while (_pop_or_steal(queue_index, task_index))
+		{
+			// 异常不能离开工作线程，否则会直接终止进程，只保留第一个，由run重新抛出
+			try {
+				(*current_task.load())(task_index);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(state_mutex);
+				if (!first_exception)
+					first_exception = std::current_exception();
+			}
+
+			if (--remaining_tasks == 0)
+			{
+				std::lock_guard<std::mutex> lock(state_mutex);
+				done_cv.notify_all();
+			}
+		}
+	}
+
+	void auto_thread_pool::_worker_loop(size_t queue_index)
+	{
+		uint64_t seen_generation = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(state_mutex);
+				start_cv.wait(lock, [&] { return stopping || generation != seen_generation; });
+				if (stopping) return;
+				seen_generation = generation;
+			}
+			_drain(queue_index);
+		}
+	}
+
+};//at
+
@@ -0,0 +1,126 @@
+#include "stdafx.h"
+#include "auto_tracker.h"
+
+namespace at {
+	int auto_tracker::add_target(const cv::Mat& template_image, double confidence)
+	{
+		if (template_image.empty()) return -1;
+
+		target new_target;
+		new_target.template_image = template_image;
+		new_target.confidence = confidence;
+		targets.push_back(std::move(new_target));
+		return static_cast<int>(targets.size()) - 1;
+	}
+
+	void auto_tracker::reset(int target_id)
+	{
+		if (target_id < 0 || target_id >= static_cast<int>(targets.size())) return;
+
+		auto& t = targets[target_id];
+		t.has_position = false;
+		t.velocity_x = t.velocity_y = 0;
+	}
+
+	bool auto_tracker::update(int target_id, const cv::Mat& screen_image, two_tuple& img_postion, time_point timestamp)
+	{
+		if (target_id < 0 || target_id >= static_cast<int>(targets.size()) || screen_image.empty()) return false;
+
+		auto& t = targets[target_id];
+		const int template_width = t.template_image.cols;
+		const int template_height = t.template_image.rows;
+		const cv::Rect frame_rect(0, 0, screen_image.cols, screen_image.rows);
+		if (template_width > frame_rect.width || template_height > frame_rect.height) return false;
+
+		double elapsed = 0, predicted_x = 0, predicted_y = 0;
+		double margin = search_margin;
+		if (t.has_position)
+		{
+			// 时间倒退时(例如回放rewind之后，或混用了默认的now()和截图时间)不做预测，只在上一次的位置附近查找
+			elapsed = std::max(0.0, std::chrono::duration<double>(timestamp - t.last_time).count());
+			predicted_x = t.x + t.velocity_x * elapsed;
+			predicted_y = t.y + t.velocity_y * elapsed;
+			if (!std::isfinite(predicted_x) || !std::isfinite(predicted_y))
+			{
+				predicted_x = t.x;
+				predicted_y = t.y;
+			}
+			// 预测的位置可能远在屏幕之外，先限制在屏幕内，再转换为整数
+			predicted_x = std::min(std::max(predicted_x, 0.0), static_cast<double>(frame_rect.width));
+			predicted_y = std::min(std::max(predicted_y, 0.0), static_cast<double>(frame_rect.height));
+			// 速度估计本身有误差，预测的位移越大，窗口留得越宽
+			margin += (std::abs(t.velocity_x) + std::abs(t.velocity_y)) * elapsed / 2;
+		}
+
+		// 窗口中心在屏幕内，留出这么宽时必然覆盖整个屏幕；margin用double计算，超过它之后直接在整个屏幕中查找，不会溢出
+		const double full_frame_margin = static_cast<double>(frame_rect.width) + frame_rect.height;
+		cv::Point matched_point;
+		bool found = false;
+		for (;;)
+		{
+			auto window = frame_rect;
+			if (t.has_position && margin < full_frame_margin)
+			{
+				const int window_margin = static_cast<int>(margin);
+				window = cv::Rect(static_cast<int>(predicted_x) - template_width / 2 - window_margin,
+					static_cast<int>(predicted_y) - template_height / 2 - window_margin,
+					template_width + 2 * window_margin, template_height + 2 * window_margin) & frame_rect;
+			}
+
+			bool is_full_frame = window == frame_rect;
+			if (is_full_frame) ++t.full_searches;
+
+			if (window.width >= template_width && window.height >= template_height &&
+				_match_in(t, screen_image, window, matched_point))
+			{
+				found = true;
+				break;
+			}
+
+			if (is_full_frame) break;
+			margin *= 4;
+		}
+
+		if (!found)
+		{
+			reset(target_id);
+			return false;
+		}
+
+		double new_x = matched_point.x + template_width / 2;
+		double new_y = matched_point.y + template_height / 2;
+		if (t.has_position && elapsed > 0)
+		{
+			// 对速度做简单的指数平滑，减少单帧误差带来的抖动
+			t.velocity_x = (t.velocity_x + (new_x - t.x) / elapsed) / 2;
+			t.velocity_y = (t.velocity_y + (new_y - t.y) / elapsed) / 2;
+			// 两帧的时间极近时速度可能溢出，此时放弃这次估计
+			if (!std::isfinite(t.velocity_x) || !std::isfinite(t.velocity_y))
+				t.velocity_x = t.velocity_y = 0;
+		}
+
+		t.x = new_x;
+		t.y = new_y;
+		t.last_time = timestamp;
+		t.has_position = true;
+
+		img_postion = { static_cast<int>(new_x), static_cast<int>(new_y) };
+		return true;
+	}
+
+	bool auto_tracker::_match_in(const target& t, const cv::Mat& screen_image, const cv::Rect& window, cv::Point& matched_point)
+	{
+		cv::cvtColor(screen_image(window), window_image, cv::COLOR_BGRA2BGR);
+		cv::matchTemplate(window_image, t.template_image, result, cv::TemplateMatchModes::TM_SQDIFF_NORMED);
+
+		double min_value = 1;
+		cv::Point min_point;
+		cv::minMaxLoc(result, &min_value, nullptr, &min_point);
+		if (1 - min_value < t.confidence) return false;
+
+		matched_point = cv::Point(min_point.x + window.x, min_point.y + window.y);
+		return true;
+	}
+
+};//at
+
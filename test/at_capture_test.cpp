@@ -0,0 +1,37 @@
+class auto_capture_test : public testing::Test
+{
+protected:
+    void SetUp() override {
+
+    }
+
+    void TearDown() override {
+        my_ac.stop();
+    }
+
+    at::auto_capture my_ac;
+};
+
+TEST_F(auto_capture_test, test_capture_frames) {
+    EXPECT_EQ(my_ac.latest_frame().sequence, 0);
+    EXPECT_FALSE(my_ac.start(0));
+    ASSERT_TRUE(my_ac.start(60));
+    EXPECT_FALSE(my_ac.start(60));
+
+    auto& first = my_ac.wait_newer_frame(0, 1000);
+    auto first_sequence = first.sequence;
+    auto first_time = first.timestamp;
+    ASSERT_GT(first_sequence, 0);
+    EXPECT_EQ(first.image.cols, GetSystemMetrics(SM_CXSCREEN));
+    EXPECT_EQ(first.image.rows, GetSystemMetrics(SM_CYSCREEN));
+
+    auto& second = my_ac.wait_newer_frame(first_sequence, 1000);
+    EXPECT_GT(second.sequence, first_sequence);
+    EXPECT_GT(second.timestamp, first_time);
+
+    my_ac.stop();
+    EXPECT_FALSE(my_ac.is_running());
+    // 停止后不再阻塞
+    auto last_sequence = my_ac.latest_frame().sequence;
+    EXPECT_EQ(my_ac.wait_newer_frame(last_sequence).sequence, last_sequence);
+}
@@ -0,0 +1,70 @@
+class auto_dispatcher_test : public testing::Test
+{
+protected:
+    void SetUp() override {
+
+    }
+
+    at::auto_dispatcher my_ad;
+};
+
+TEST_F(auto_dispatcher_test, test_producer_order) {
+    constexpr int producer_count = 4;
+    constexpr int action_count = 1000;
+
+    // 动作只在分发线程上执行，所以不需要加锁
+    std::vector<std::pair<int, int>> executed;
+    std::vector<std::future<bool>> results[producer_count];
+    std::vector<std::thread> producers;
+
+    ASSERT_TRUE(my_ad.start());
+    for (int p = 0; p < producer_count; ++p)
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < action_count; ++i)
+                results[p].push_back(my_ad.post([&executed, p, i](at::auto_input&) {
+                    executed.push_back({ p, i });
+                    return true;
+                }).result);
+        });
+
+    for (auto&& t : producers)
+        t.join();
+    for (auto&& r : results)
+        for (auto&& f : r)
+            EXPECT_TRUE(f.get());
+
+    ASSERT_EQ(executed.size(), producer_count * action_count);
+    int next_index[producer_count] = { 0 };
+    for (auto&& e : executed)
+        EXPECT_EQ(e.second, next_index[e.first]++);
+}
+
+TEST_F(auto_dispatcher_test, test_priority_and_cancel) {
+    std::vector<int> executed;
+    auto record = [&executed](int id) {
+        return [&executed, id](at::auto_input&) { executed.push_back(id); return true; };
+    };
+
+    // 启动前提交，使所有动作同时处于队列中
+    auto low = my_ad.post(record(0), at::auto_dispatcher::priority_type::low);
+    auto normal = my_ad.post(record(1));
+    auto cancelled = my_ad.post(record(2), at::auto_dispatcher::priority_type::high);
+    auto high = my_ad.post(record(3), at::auto_dispatcher::priority_type::high);
+
+    EXPECT_TRUE(cancelled.cancel());
+    EXPECT_FALSE(cancelled.cancel());
+    EXPECT_FALSE(cancelled.result.get());
+
+    ASSERT_TRUE(my_ad.start());
+    EXPECT_TRUE(low.result.get());
+    EXPECT_TRUE(normal.result.get());
+    EXPECT_TRUE(high.result.get());
+    EXPECT_FALSE(high.cancel());
+
+    EXPECT_EQ(executed, std::vector<int>({ 3, 1, 0 }));
+
+    my_ad.stop();
+    auto after_stop = my_ad.post(record(4));
+    my_ad.stop();
+    EXPECT_FALSE(after_stop.result.get());
+}
@@ -0,0 +1,91 @@
+class auto_frame_log_test : public testing::Test
+{
+protected:
+    void SetUp() override {
+
+    }
+
+    void TearDown() override {
+        std::remove(log_file_name);
+    }
+
+    const char* log_file_name = "at_frame_log_test.atfl";
+    at::auto_frame_logger my_afl;
+    at::auto_frame_replay my_afr;
+};
+
+TEST_F(auto_frame_log_test, test_log_and_replay) {
+    constexpr int frame_count = 12;
+    std::vector<at::auto_capture::frame> frames(frame_count);
+    auto timestamp = std::chrono::steady_clock::now();
+
+    // 宽高都不是图块边长的整数倍，覆盖不满的边缘图块
+    cv::Mat background(150, 230, CV_8UC4);
+    cv::randu(background, 0, 256);
+    for (int i = 0; i < frame_count; ++i)
+    {
+        auto& f = frames[i];
+        f.image = background.clone();
+        f.sequence = i + 1;
+        f.timestamp = timestamp + std::chrono::milliseconds(16 * i);
+        // 一个小方块在画面中移动，第8帧整个画面都变化，触发新的关键帧
+        f.image(cv::Rect(10 + i * 15, 20 + i * 8, 12, 12)).setTo(cv::Scalar(0, 0, 255, 255));
+        if (i == 8)
+            f.image.setTo(cv::Scalar(255, 255, 255, 255));
+    }
+
+    ASSERT_TRUE(my_afl.open(log_file_name, 32, 5, frame_count));
+    for (auto&& f : frames)
+        EXPECT_TRUE(my_afl.push(f));
+    my_afl.close();
+    EXPECT_EQ(my_afl.dropped_frames(), 0);
+    EXPECT_FALSE(my_afl.push(frames[0]));
+
+    ASSERT_TRUE(my_afr.open(log_file_name));
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        at::auto_capture::frame replayed;
+        for (auto&& f : frames)
+        {
+            ASSERT_TRUE(my_afr.next_frame(replayed));
+            EXPECT_EQ(replayed.sequence, f.sequence);
+            EXPECT_EQ(replayed.timestamp, f.timestamp);
+            EXPECT_EQ(cv::norm(replayed.image, f.image, cv::NORM_INF), 0);
+        }
+        EXPECT_FALSE(my_afr.next_frame(replayed));
+        ASSERT_TRUE(my_afr.rewind());
+    }
+}
+
+TEST_F(auto_frame_log_test, test_corrupted_log) {
+    at::auto_capture::frame f;
+    f.image.create(40, 60, CV_8UC4);
+    cv::randu(f.image, 0, 256);
+    f.sequence = 1;
+    f.timestamp = std::chrono::steady_clock::now();
+
+    ASSERT_TRUE(my_afl.open(log_file_name, 32));
+    EXPECT_TRUE(my_afl.push(f));
+    my_afl.close();
+
+    // 文件头12字节，第一条记录的类型、序号、时间戳、宽、高、图块数量共29字节，之后是原始大小和压缩后大小
+    constexpr std::streamoff raw_size_offset = 12 + 29;
+    constexpr std::streamoff width_offset = 12 + 17;
+    auto patch = [&](std::streamoff offset, uint32_t value) {
+        std::fstream file(log_file_name, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    at::auto_capture::frame replayed;
+    patch(raw_size_offset, 0xfffffff0u);
+    ASSERT_TRUE(my_afr.open(log_file_name));
+    EXPECT_FALSE(my_afr.next_frame(replayed));
+
+    // 宽高也被改大时，压缩后大小仍然不能超过文件剩余的字节数
+    patch(width_offset, 0x7fffffffu);
+    patch(raw_size_offset, 0x7fff0000u);
+    patch(raw_size_offset + 4, 0x7fff0000u);
+    ASSERT_TRUE(my_afr.open(log_file_name));
+    EXPECT_FALSE(my_afr.next_frame(replayed));
+}
@@ -0,0 +1,46 @@
+class auto_macro_test : public testing::Test
+{
+protected:
+    void SetUp() override {
+
+    }
+
+    at::auto_input my_ai;
+    at::auto_screen my_as;
+    at::auto_macro my_am;
+};
+
+TEST_F(auto_macro_test, test_compile_errors) {
+    std::string error;
+    EXPECT_TRUE(my_am.compile("# comment\npress ctrl a\ntype Hello, World!\nwait 10\nloop 2\nclick right 10 20\nend\n", &error));
+    EXPECT_FALSE(my_am.compile("press no_such_key", &error));
+    EXPECT_EQ(error, "line 1: unknown key 'no_such_key'");
+    // 鼠标按钮和点击方式的名字不是按键，方向键要写arrow_up等
+    EXPECT_FALSE(my_am.compile("press up", &error));
+    EXPECT_EQ(error, "line 1: unknown key 'up'");
+    EXPECT_FALSE(my_am.compile("press ctrl left", &error));
+    EXPECT_EQ(error, "line 1: unknown key 'left'");
+    EXPECT_TRUE(my_am.compile("press arrow_up arrow_left", &error));
+    EXPECT_FALSE(my_am.compile("loop 3\nwait 1\n", &error));
+    EXPECT_EQ(error, "line 2: missing end");
+    EXPECT_FALSE(my_am.compile("wait 1\nelse\n", &error));
+    EXPECT_EQ(error, "line 2: else without if_found");
+    EXPECT_FALSE(my_am.compile("end", &error));
+    EXPECT_FALSE(my_am.compile("move 1", &error));
+    EXPECT_FALSE(my_am.compile("jump 1", &error));
+    EXPECT_FALSE(my_am.compile("find no_such_image.png", &error));
+}
+
+TEST_F(auto_macro_test, test_interpret_overhead) {
+    // 只包含控制流指令，测得的是解释器本身每条指令的开销
+    ASSERT_TRUE(my_am.compile("loop 1000\nloop 1000\nend\nloop 0\nwait 1000\nend\nend\n"));
+
+    auto begin = std::chrono::steady_clock::now();
+    ASSERT_TRUE(my_am.run(my_ai, my_as));
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+
+    // 外层1次loop_begin、halt，每次外层迭代1次内层loop_begin、1000次loop_end、1次跳过的loop_begin、1次loop_end
+    EXPECT_EQ(my_am.executed_steps(), 1000 * 1003 + 2);
+    std::cout << "nanoseconds per step: "
+        << std::chrono::duration<double, std::nano>(elapsed).count() / my_am.executed_steps() << "\n";
+}
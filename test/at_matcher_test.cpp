@@ -0,0 +1,168 @@
+// 统计矩阵缓冲分配次数的分配器，实际分配交给原来的默认分配器。
+// cv::Mat及opencv内部的临时矩阵都通过默认分配器申请内存，opencv是动态库时也一样，所以它能看到所有矩阵分配
+class counting_allocator : public cv::MatAllocator
+{
+public:
+    explicit counting_allocator(cv::MatAllocator* base) : base(base) {}
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+        cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override {
+        ++count;
+        return base->allocate(dims, sizes, type, data, step, flags, usage_flags);
+    }
+
+    bool allocate(cv::UMatData* data, cv::AccessFlag access_flags, cv::UMatUsageFlags usage_flags) const override {
+        return base->allocate(data, access_flags, usage_flags);
+    }
+
+    void deallocate(cv::UMatData* data) const override {
+        base->deallocate(data);
+    }
+
+    mutable std::atomic<size_t> count{ 0 };
+
+private:
+    cv::MatAllocator* base;
+};
+
+// 替换全局的operator new，只在counting_new_calls为true时计数。auto_tools是静态库，会话自己的代码分配内存都会经过这里，
+// opencv是动态库，它内部的分配不经过这里，由上面的分配器统计
+namespace {
+    std::atomic<bool> counting_new_calls{ false };
+    std::atomic<size_t> new_call_count{ 0 };
+}
+
+void* operator new(std::size_t size)
+{
+    if (counting_new_calls.load(std::memory_order_relaxed))
+        ++new_call_count;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+class auto_matcher_test : public testing::Test
+{
+protected:
+    void SetUp() override {
+        screen_image.create(720, 1280, CV_8UC4);
+        cv::randu(screen_image, 0, 256);
+
+        // 两个大小不同的模板，结果矩阵的大小也不同
+        cv::cvtColor(screen_image(cv::Rect(300, 200, 40, 24)), small_template, cv::COLOR_BGRA2BGR);
+        cv::cvtColor(screen_image(cv::Rect(900, 500, 96, 64)), large_template, cv::COLOR_BGRA2BGR);
+    }
+
+    // 统计函数执行期间分配矩阵缓冲的次数
+    template <class F>
+    size_t count_allocations(F&& f) {
+        auto default_allocator = cv::Mat::getDefaultAllocator();
+        counting_allocator allocator(default_allocator);
+        cv::Mat::setDefaultAllocator(&allocator);
+        f();
+        cv::Mat::setDefaultAllocator(default_allocator);
+        return allocator.count;
+    }
+
+    // 统计函数执行期间operator new被调用的次数
+    template <class F>
+    size_t count_new_calls(F&& f) {
+        new_call_count = 0;
+        counting_new_calls = true;
+        f();
+        counting_new_calls = false;
+        return new_call_count;
+    }
+
+    cv::Mat screen_image;
+    cv::Mat small_template;
+    cv::Mat large_template;
+    at::auto_screen my_as;
+};
+
+TEST_F(auto_matcher_test, test_same_as_auto_screen) {
+    at::auto_matcher my_am;
+    int small_id = my_am.add_template(small_template);
+    int large_id = my_am.add_template(large_template);
+    ASSERT_EQ(small_id, 0);
+    ASSERT_EQ(large_id, 1);
+
+    for (auto&& [id, template_image] : { std::make_pair(small_id, small_template), std::make_pair(large_id, large_template) })
+    {
+        std::vector<at::auto_screen::two_tuple> expected;
+        ASSERT_TRUE(my_as.find_img_from_mat(expected, template_image, screen_image));
+        ASSERT_TRUE(my_am.find_img_from_mat(id, screen_image));
+        EXPECT_EQ(my_am.img_postion(), expected);
+    }
+    ASSERT_EQ(my_am.img_postion().size(), 1);
+    EXPECT_EQ(my_am.img_postion()[0], at::auto_matcher::two_tuple(900 + 48, 500 + 32));
+}
+
+TEST_F(auto_matcher_test, test_invalid_template) {
+    at::auto_matcher my_am;
+    EXPECT_EQ(my_am.add_template(cv::Mat()), -1);
+    EXPECT_EQ(my_am.add_template(screen_image), -1);
+    EXPECT_FALSE(my_am.find_img_from_mat(0, screen_image));
+
+    int id = my_am.add_template(large_template);
+    EXPECT_FALSE(my_am.find_img_from_mat(id, screen_image(cv::Rect(0, 0, 64, 64))));
+    EXPECT_TRUE(my_am.img_postion().empty());
+}
+
+TEST_F(auto_matcher_test, test_steady_state_no_allocation) {
+    at::auto_matcher my_am;
+    int small_id = my_am.add_template(small_template);
+    int large_id = my_am.add_template(large_template);
+    my_am.reserve(screen_image.cols, screen_image.rows);
+    ASSERT_TRUE(my_am.find_img_from_mat(small_id, screen_image));
+    ASSERT_TRUE(my_am.find_img_from_mat(large_id, screen_image));
+
+    // matchTemplate内部会自己申请临时矩阵，用预先分配好输出的同样调用作为基准，会话本身不能再多分配
+    cv::Mat screen_image_3channel(screen_image.rows, screen_image.cols, CV_8UC3);
+    cv::Mat small_result(screen_image.rows - small_template.rows + 1, screen_image.cols - small_template.cols + 1, CV_32FC1);
+    cv::Mat large_result(screen_image.rows - large_template.rows + 1, screen_image.cols - large_template.cols + 1, CV_32FC1);
+    auto baseline = count_allocations([&] {
+        for (int i = 0; i < 5; ++i)
+        {
+            cv::cvtColor(screen_image, screen_image_3channel, cv::COLOR_BGRA2BGR);
+            cv::matchTemplate(screen_image_3channel, small_template, small_result, cv::TemplateMatchModes::TM_SQDIFF_NORMED);
+            cv::cvtColor(screen_image, screen_image_3channel, cv::COLOR_BGRA2BGR);
+            cv::matchTemplate(screen_image_3channel, large_template, large_result, cv::TemplateMatchModes::TM_SQDIFF_NORMED);
+        }
+    });
+
+    // 在两个结果大小不同的模板之间来回切换，输出的vector也不能重新分配
+    auto postion_data = my_am.img_postion().data();
+    size_t session_new_calls = 0;
+    auto session = count_allocations([&] {
+        session_new_calls = count_new_calls([&] {
+            for (int i = 0; i < 5; ++i)
+            {
+                my_am.find_img_from_mat(small_id, screen_image);
+                my_am.find_img_from_mat(large_id, screen_image);
+            }
+        });
+    });
+
+    std::vector<at::auto_screen::two_tuple> postion;
+    auto one_shot = count_allocations([&] {
+        for (int i = 0; i < 5; ++i)
+        {
+            postion.clear();
+            my_as.find_img_from_mat(postion, small_template, screen_image);
+            postion.clear();
+            my_as.find_img_from_mat(postion, large_template, screen_image);
+        }
+    });
+
+    // 会话自己的代码不能分配任何内存，矩阵缓冲也不能比opencv自己多
+    EXPECT_EQ(session_new_calls, 0);
+    EXPECT_EQ(session, baseline);
+    EXPECT_EQ(my_am.img_postion().data(), postion_data);
+    EXPECT_EQ(my_am.img_postion().size(), 1);
+    // auto_screen每次调用都要新建BGR矩阵和结果矩阵
+    EXPECT_GE(one_shot, baseline + 2 * 10);
+}
@@ -0,0 +1,81 @@
+class auto_parallel_match_test : public testing::Test
+{
+protected:
+    void SetUp() override {
+        screen_image.create(1440, 2560, CV_8UC4);
+        cv::randu(screen_image, 0, 256);
+
+        // 模板取自屏幕，并在另一处再放一份，跨越多个条带的边界
+        cv::Mat template_bgra = screen_image(cv::Rect(1000, 700, 48, 40)).clone();
+        template_bgra.copyTo(screen_image(cv::Rect(20, 1390, 48, 40)));
+        cv::cvtColor(template_bgra, template_image, cv::COLOR_BGRA2BGR);
+    }
+
+    cv::Mat screen_image;
+    cv::Mat template_image;
+    at::auto_screen my_as;
+};
+
+TEST_F(auto_parallel_match_test, test_same_as_single_thread) {
+    at::auto_parallel_match my_apm(4);
+
+    std::vector<at::auto_screen::two_tuple> expected, postion;
+    ASSERT_TRUE(my_as.find_img_from_mat(expected, template_image, screen_image));
+    ASSERT_TRUE(my_apm.find_img_from_mat(postion, template_image, screen_image));
+    EXPECT_EQ(expected.size(), 2);
+    EXPECT_EQ(postion, expected);
+
+    // 得分只可能有matchTemplate内部分块计算带来的浮点舍入差异
+    cv::Mat screen_image_3channel, single_result, parallel_result;
+    cv::cvtColor(screen_image, screen_image_3channel, cv::COLOR_BGRA2BGR);
+    cv::matchTemplate(screen_image_3channel, template_image, single_result, cv::TemplateMatchModes::TM_SQDIFF_NORMED);
+    ASSERT_TRUE(my_apm.match_template(screen_image, template_image, parallel_result));
+    EXPECT_LT(cv::norm(single_result, parallel_result, cv::NORM_INF), 1e-5);
+}
+
+TEST_F(auto_parallel_match_test, test_scaling) {
+    std::vector<at::auto_screen::two_tuple> postion;
+    auto benchmark = [&](auto&& find) {
+        find();
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < 5; ++i)
+            find();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / 5;
+    };
+
+    auto single_ms = benchmark([&] { postion.clear(); my_as.find_img_from_mat(postion, template_image, screen_image); });
+    std::cout << "single thread: " << single_ms << " ms\n";
+
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        at::auto_parallel_match my_apm(threads);
+        auto parallel_ms = benchmark([&] { postion.clear(); my_apm.find_img_from_mat(postion, template_image, screen_image); });
+        std::cout << threads << " threads: " << parallel_ms << " ms, speedup " << single_ms / parallel_ms << "\n";
+        EXPECT_EQ(postion.size(), 2);
+    }
+}
+
+TEST_F(auto_parallel_match_test, test_task_exception) {
+    at::auto_thread_pool pool(4);
+    std::atomic<size_t> finished{ 0 };
+    EXPECT_THROW(pool.run(64, [&](size_t i) {
+        if (i % 7 == 3) throw std::runtime_error("task failed");
+        ++finished;
+    }), std::runtime_error);
+    // 其余任务照常执行完，之后线程池仍然可用
+    EXPECT_EQ(finished, 64 - 9);
+
+    finished = 0;
+    pool.run(64, [&](size_t) { ++finished; });
+    EXPECT_EQ(finished, 64);
+
+    // 类型不对时返回false，而不是在工作线程中抛出异常
+    at::auto_parallel_match my_apm(4);
+    cv::Mat template_bgra, result;
+    cv::cvtColor(template_image, template_bgra, cv::COLOR_BGR2BGRA);
+    EXPECT_FALSE(my_apm.match_template(screen_image, template_bgra, result));
+    cv::Mat screen_image_3channel;
+    cv::cvtColor(screen_image, screen_image_3channel, cv::COLOR_BGRA2BGR);
+    EXPECT_FALSE(my_apm.match_template(screen_image_3channel, template_image, result));
+}
@@ -0,0 +1,93 @@
+class auto_prefilter_test : public testing::Test
+{
+protected:
+    void SetUp() override {
+
+    }
+
+    at::auto_screen my_as;
+    at::auto_prefilter my_apf;
+};
+
+TEST_F(auto_prefilter_test, test_prefilter_regions) {
+    // 红绿两色的模板，放在灰色背景上
+    cv::Mat template_image(20, 30, CV_8UC3, cv::Scalar(0, 0, 220));
+    template_image(cv::Rect(0, 10, 30, 10)).setTo(cv::Scalar(0, 220, 0));
+    cv::Mat template_bgra;
+    cv::cvtColor(template_image, template_bgra, cv::COLOR_BGR2BGRA);
+
+    cv::Mat frame(300, 500, CV_8UC4, cv::Scalar(90, 90, 90, 255));
+    template_bgra.copyTo(frame(cv::Rect(333, 147, template_image.cols, template_image.rows)));
+
+    auto template_signature = at::auto_prefilter::make_signature(template_image);
+    EXPECT_EQ(template_signature.dominant_count, 2);
+
+    ASSERT_TRUE(my_apf.build(frame, 32));
+    std::vector<cv::Rect> regions;
+    ASSERT_TRUE(my_apf.candidate_regions(template_signature, regions));
+    int region_area = 0;
+    for (auto&& r : regions)
+        region_area += r.area();
+    EXPECT_LT(region_area, frame.rows * frame.cols / 4);
+
+    std::vector<at::auto_prefilter::two_tuple> expected, postion;
+    ASSERT_TRUE(my_as.find_img_from_mat(expected, template_image, frame));
+    ASSERT_TRUE(my_apf.find_img_from_mat(postion, template_image, template_signature, frame));
+    EXPECT_EQ(postion, expected);
+
+    // 蓝色的模板在屏幕上完全没有，不需要匹配
+    cv::Mat absent_image(20, 20, CV_8UC3, cv::Scalar(230, 0, 0));
+    EXPECT_FALSE(my_apf.candidate_regions(at::auto_prefilter::make_signature(absent_image), regions));
+    EXPECT_TRUE(regions.empty());
+}
+
+TEST_F(auto_prefilter_test, test_same_as_auto_screen_across_tile_rows) {
+    // 模板足够高，上下错开一行时仍达到信心
+    cv::Mat template_image(40, 30, CV_8UC3, cv::Scalar(0, 0, 220));
+    template_image(cv::Rect(0, 20, 30, 20)).setTo(cv::Scalar(0, 220, 0));
+    cv::Mat template_bgra;
+    cv::cvtColor(template_image, template_bgra, cv::COLOR_BGR2BGRA);
+
+    // 三处分别在不同的图块行，右上的先被逐区域找到，但整个结果矩阵按列扫描时左下的在前；
+    // 中间一处的左上角在第159行，上下错开一行的位置分别落在图块边界160两侧
+    cv::Mat frame(300, 500, CV_8UC4, cv::Scalar(90, 90, 90, 255));
+    template_bgra.copyTo(frame(cv::Rect(400, 30, template_image.cols, template_image.rows)));
+    template_bgra.copyTo(frame(cv::Rect(200, 159, template_image.cols, template_image.rows)));
+    template_bgra.copyTo(frame(cv::Rect(60, 250, template_image.cols, template_image.rows)));
+
+    auto template_signature = at::auto_prefilter::make_signature(template_image);
+    ASSERT_TRUE(my_apf.build(frame, 32));
+
+    std::vector<at::auto_prefilter::two_tuple> expected, postion;
+    ASSERT_TRUE(my_as.find_img_from_mat(expected, template_image, frame));
+    ASSERT_TRUE(my_apf.find_img_from_mat(postion, template_image, template_signature, frame));
+    EXPECT_EQ(expected.size(), 3);
+    EXPECT_EQ(postion, expected);
+
+    // 模板的颜色在屏幕上到处都是时，不再分块，直接返回整个屏幕
+    cv::Mat common_image(20, 30, CV_8UC3, cv::Scalar(90, 90, 90));
+    std::vector<cv::Rect> regions;
+    ASSERT_TRUE(my_apf.candidate_regions(at::auto_prefilter::make_signature(common_image), regions));
+    ASSERT_EQ(regions.size(), 1);
+    EXPECT_EQ(regions[0], cv::Rect(0, 0, frame.cols, frame.rows));
+}
+
+TEST_F(auto_prefilter_test, test_invalid_screen) {
+    cv::Mat template_image(20, 30, CV_8UC3, cv::Scalar(0, 0, 220));
+    auto template_signature = at::auto_prefilter::make_signature(template_image);
+    std::vector<at::auto_prefilter::two_tuple> postion;
+    std::vector<cv::Rect> regions;
+
+    // 不是BGRA四通道的屏幕不能统计，之后的筛选也不能把它当成模板不在屏幕上
+    cv::Mat frame_3channel(300, 500, CV_8UC3, cv::Scalar(0, 0, 220));
+    EXPECT_FALSE(my_apf.build(frame_3channel, 32));
+    EXPECT_FALSE(my_apf.candidate_regions(template_signature, regions));
+
+    // 与build时大小不同的屏幕
+    cv::Mat frame(300, 500, CV_8UC4, cv::Scalar(0, 0, 220, 255));
+    ASSERT_TRUE(my_apf.build(frame, 32));
+    EXPECT_TRUE(my_apf.find_img_from_mat(postion, template_image, template_signature, frame));
+    postion.clear();
+    EXPECT_FALSE(my_apf.find_img_from_mat(postion, template_image, template_signature, frame(cv::Rect(0, 0, 200, 100))));
+    EXPECT_TRUE(postion.empty());
+}
@@ -0,0 +1,50 @@
+class auto_recorder_test : public testing::Test
+{
+protected:
+    void SetUp() override {
+
+    }
+
+    at::auto_input my_ai;
+    at::auto_recorder my_ar;
+};
+
+TEST_F(auto_recorder_test, test_record_injected_input) {
+    // auto_input产生的是注入的输入，需要显式要求录制
+    ASSERT_TRUE(my_ar.start(true));
+    EXPECT_FALSE(my_ar.start(true));
+
+    at::auto_recorder other;
+    EXPECT_FALSE(other.start());
+
+    my_ai.move_to(100, 100);
+    my_ai.press(VK_SHIFT);
+    my_ai.wait(100);
+    my_ar.stop();
+    EXPECT_FALSE(my_ar.is_recording());
+
+    auto events = my_ar.events();
+    EXPECT_EQ(my_ar.dropped_events(), 0);
+    ASSERT_FALSE(events.empty());
+    EXPECT_EQ(events.front().type, at::auto_recorder::event_type::mouse_move);
+
+    auto key_down = std::find_if(events.begin(), events.end(), [](const at::auto_recorder::input_event& e) {
+        return e.type == at::auto_recorder::event_type::key_down;
+    });
+    ASSERT_NE(key_down, events.end());
+    // 低级钩子通常会把VK_SHIFT报告为区分左右的VK_LSHIFT
+    EXPECT_TRUE(key_down->data == VK_SHIFT || key_down->data == VK_LSHIFT);
+
+    auto il = my_ar.to_input_list();
+    EXPECT_GE(il.size(), events.size());
+}
+
+TEST_F(auto_recorder_test, test_buffer_full) {
+    at::auto_recorder small_recorder(2);
+    ASSERT_TRUE(small_recorder.start(true));
+    my_ai.move_to(300, 300);
+    small_recorder.stop();
+
+    EXPECT_EQ(small_recorder.events().size(), 2);
+    EXPECT_GT(small_recorder.dropped_events(), 0);
+}
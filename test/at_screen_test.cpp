@@ -41,4 +41,23 @@ TEST_F(auto_screen_test, test_screen_catch) {
 
     my_ai.press({"q","u","e","s","h","i","1","enter"});
 
-}
\ No newline at end of file
+}
+TEST_F(auto_screen_test, test_scan_color) {
+    // 宽度取37，覆盖4像素一组的向量部分和剩余的标量部分
+    cv::Mat image(5, 37, CV_8UC4, cv::Scalar(10, 20, 30, 255));
+    image.at<cv::Vec4b>(0, 0) = cv::Vec4b(200, 100, 50, 0);
+    image.at<cv::Vec4b>(2, 17) = cv::Vec4b(203, 98, 50, 255);
+    image.at<cv::Vec4b>(4, 36) = cv::Vec4b(200, 100, 52, 7);
+    image.at<cv::Vec4b>(3, 5) = cv::Vec4b(210, 100, 50, 0);
+
+    EXPECT_EQ(at::auto_screen::scan_color(image, RGB(50, 100, 200), 0), 1);
+    EXPECT_EQ(at::auto_screen::scan_color(image, RGB(50, 100, 200), 3), 3);
+    EXPECT_EQ(at::auto_screen::scan_color(image, RGB(30, 20, 10), 0), 5 * 37 - 4);
+
+    std::vector<at::auto_screen::two_tuple> postion;
+    EXPECT_EQ(at::auto_screen::scan_color(image, RGB(50, 100, 200), 3, &postion, { 100, 200 }), 3);
+    ASSERT_EQ(postion.size(), 3);
+    EXPECT_EQ(postion[0], at::auto_screen::two_tuple(100, 200));
+    EXPECT_EQ(postion[1], at::auto_screen::two_tuple(117, 202));
+    EXPECT_EQ(postion[2], at::auto_screen::two_tuple(136, 204));
+}
@@ -0,0 +1,76 @@
+class auto_tracker_test : public testing::Test
+{
+protected:
+    void SetUp() override {
+
+    }
+
+    at::auto_tracker my_at;
+};
+
+TEST_F(auto_tracker_test, test_track_moving_target) {
+    cv::Mat template_image(24, 24, CV_8UC3), template_bgra;
+    cv::randu(template_image, 0, 256);
+    cv::cvtColor(template_image, template_bgra, cv::COLOR_BGR2BGRA);
+
+    auto target_id = my_at.add_target(template_image);
+    ASSERT_EQ(target_id, 0);
+
+    cv::Mat frame(600, 800, CV_8UC4);
+    auto timestamp = std::chrono::steady_clock::now();
+    for (int i = 0; i < 30; ++i)
+    {
+        int x = 100 + i * 15, y = 80 + i * 9;
+        frame.setTo(cv::Scalar(40, 40, 40, 255));
+        template_bgra.copyTo(frame(cv::Rect(x, y, template_image.cols, template_image.rows)));
+
+        at::auto_tracker::two_tuple postion;
+        ASSERT_TRUE(my_at.update(target_id, frame, postion, timestamp + std::chrono::milliseconds(33 * i)));
+        EXPECT_EQ(postion, at::auto_tracker::two_tuple(x + 12, y + 12));
+    }
+
+    // 只有第一帧在整个屏幕中查找，之后都在预测窗口中找到
+    EXPECT_EQ(my_at.full_frame_searches(target_id), 1);
+
+    // 目标消失后回退到整个屏幕查找
+    frame.setTo(cv::Scalar(40, 40, 40, 255));
+    at::auto_tracker::two_tuple postion;
+    EXPECT_FALSE(my_at.update(target_id, frame, postion));
+    EXPECT_EQ(my_at.full_frame_searches(target_id), 2);
+    EXPECT_EQ(my_at.full_frame_searches(target_id + 1), 0);
+    EXPECT_EQ(my_at.full_frame_searches(-1), 0);
+}
+
+TEST_F(auto_tracker_test, test_timestamp_going_backwards) {
+    cv::Mat template_image(24, 24, CV_8UC3), template_bgra;
+    cv::randu(template_image, 0, 256);
+    cv::cvtColor(template_image, template_bgra, cv::COLOR_BGR2BGRA);
+    auto target_id = my_at.add_target(template_image);
+
+    cv::Mat frame(600, 800, CV_8UC4);
+    auto place = [&](int x, int y) {
+        frame.setTo(cv::Scalar(40, 40, 40, 255));
+        template_bgra.copyTo(frame(cv::Rect(x, y, template_image.cols, template_image.rows)));
+    };
+
+    // 先建立速度估计
+    auto timestamp = std::chrono::steady_clock::now();
+    at::auto_tracker::two_tuple postion;
+    for (int i = 0; i < 10; ++i)
+    {
+        place(100 + i * 15, 80 + i * 9);
+        ASSERT_TRUE(my_at.update(target_id, frame, postion, timestamp + std::chrono::milliseconds(33 * i)));
+    }
+
+    // 像回放rewind之后一样，时间回到开头，目标也回到起点
+    place(100, 80);
+    ASSERT_TRUE(my_at.update(target_id, frame, postion, timestamp - std::chrono::milliseconds(100)));
+    EXPECT_EQ(postion, at::auto_tracker::two_tuple(112, 92));
+
+    // 两帧几乎同时却相距很远，速度估计极大，下一帧的预测远在屏幕之外
+    place(700, 500);
+    ASSERT_TRUE(my_at.update(target_id, frame, postion, timestamp - std::chrono::milliseconds(100) + std::chrono::nanoseconds(1)));
+    place(300, 300);
+    ASSERT_TRUE(my_at.update(target_id, frame, postion, timestamp + std::chrono::seconds(1)));
+    EXPECT_EQ(postion, at::auto_tracker::two_tuple(312, 312));
+}